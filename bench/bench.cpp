@@ -0,0 +1,233 @@
+#include <include.h>
+#include <corpus.hpp>
+
+#include <optional>
+#include <fstream>
+
+namespace {
+    const std::string USAGE =
+        "Usage: asm-analyze-bench [options]\n"
+        "\n"
+        "Runs the microbenchmarks, then analyzes a generated corpus of every style at each size.\n"
+        "\n"
+        "Options:\n"
+        "  --sizes LIST                   Comma-separated corpus sizes, e.g. 1M,64M,1G (default: 1M,16M)\n"
+        "  -j, --jobs N                   Threads of the parallel end-to-end run (default: hardware concurrency)\n"
+        "  --filter TEXT                  Only run the benchmarks whose name contains TEXT\n"
+        "  --generate STYLE SIZE FILE     Write a corpus (gcc, nasm or data) to FILE and exit\n"
+        "  -h, --help                     Show this help\n";
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double MIN_SECONDS = 0.25; // per microbenchmark
+
+    /**
+     * Keeps the compiler from discarding a benchmarked result.
+     */
+    template <typename T>
+    void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    [[nodiscard]] auto seconds(Clock::time_point begin) -> double {
+        return std::chrono::duration<double>(Clock::now() - begin).count();
+    }
+
+    /**
+     * @return The size in bytes of a string like "512K", "16M" or "1G" (0 if invalid).
+     */
+    [[nodiscard]] auto parseSize(std::string_view text) -> size_t {
+        size_t value = 0;
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc() || value == 0) return 0;
+        std::string_view suffix(end, static_cast<size_t>(text.data() + text.size() - end));
+        if (suffix.empty()) return value;
+        if (suffix.size() > 1) return 0;
+        switch (std::toupper(static_cast<unsigned char>(suffix[0]))) {
+        case 'K': return value << 10;
+        case 'M': return value << 20;
+        case 'G': return value << 30;
+        default: return 0;
+        }
+    }
+
+    [[nodiscard]] auto parseStyle(std::string_view name) -> std::optional<corpus::Style> {
+        for (size_t i = 0; i < corpus::STYLE_NAMES.size(); ++i) {
+            if (corpus::STYLE_NAMES[i] == name) return static_cast<corpus::Style>(i);
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Calls `fn(input)` over the inputs, doubling the repetitions until the run takes
+     * MIN_SECONDS, and prints the time per call.
+     */
+    template <typename Fn>
+    void micro(std::string_view name, const std::vector<std::string>& inputs, Fn&& fn) {
+        size_t calls = inputs.size();
+        double elapsed = 0;
+        for (size_t rounds = 1;; rounds *= 2) {
+            auto begin = Clock::now();
+            for (size_t r = 0; r < rounds; ++r) {
+                for (const std::string& input : inputs) fn(input);
+            }
+            elapsed = seconds(begin);
+            calls = rounds * inputs.size();
+            if (elapsed >= MIN_SECONDS) break;
+        }
+        std::printf("%-28s %10.1f ns/op\n", std::string(name).c_str(), elapsed * 1e9 / static_cast<double>(calls));
+    }
+
+    /**
+     * @return Every line of `source`, without the line terminators.
+     */
+    [[nodiscard]] auto lines(std::string_view source) -> std::vector<std::string> {
+        std::vector<std::string> result;
+        io::LineReader reader(source);
+        std::string_view line;
+        while (reader.next(line)) result.emplace_back(line);
+        return result;
+    }
+
+    void microbenchmarks(std::string_view filter) {
+        auto enabled = [filter](std::string_view name) { return name.find(filter) != std::string_view::npos; };
+
+        // A mixed sample, so that branch predictors do not learn a single pattern
+        std::vector<std::string> sample;
+        for (corpus::Style style : {corpus::GCC, corpus::NASM, corpus::DATA}) {
+            for (std::string& line : lines(corpus::Generator(style, 7).generate(64 << 10))) sample.push_back(std::move(line));
+        }
+
+        std::vector<std::string> operands;
+        std::vector<std::string> opcodes;
+        for (const std::string& line : sample) {
+            std::string trimmed(trim(line));
+            size_t space = trimmed.find_first_of(" \t");
+            opcodes.push_back(trimmed.substr(0, space));
+            if (space == std::string::npos) continue;
+            std::string rest = trimmed.substr(space + 1);
+            operands.emplace_back(trim(rest.substr(0, rest.find(','))));
+        }
+
+        std::vector<std::string> sources = {corpus::Generator(corpus::GCC).generate(4 << 10)};
+
+        std::printf("%-28s %13s\n", "microbenchmark", "time");
+        std::string tokenizer = "tokenize (" + std::string(scan::LEVEL_NAMES[scan::LEVEL]) + ")";
+        if (enabled("tokenize"))
+            micro(tokenizer, sample, [](const std::string& line) { doNotOptimize(scan::tokenize(line)); });
+        if (enabled("trim"))
+            micro("trim", sample, [](const std::string& line) { doNotOptimize(trim(line)); });
+        if (enabled("isInstruction"))
+            micro("isInstruction", opcodes, [](const std::string& opcode) { doNotOptimize(isInstruction(opcode)); });
+        if (enabled("analyzeOperand")) {
+            micro("analyzeOperand", operands, [](const std::string& operand) {
+                std::string copy = operand;
+                doNotOptimize(analyzeOperand(copy));
+            });
+        }
+        if (enabled("classifyOperand")) {
+            micro("classifyOperand", operands, [](const std::string& operand) { doNotOptimize(classifyOperand(operand)); });
+            intern::Arena arena;
+            analysis::OperandCache cache(arena);
+            micro("classifyOperand (interned)", operands, [&cache](const std::string& operand) { doNotOptimize(classifyOperand(operand, &cache)); });
+        }
+        if (enabled("analyzeLine"))
+            micro("analyzeLine", sample, [](const std::string& line) { doNotOptimize(analyzeLine(line)); });
+        if (enabled("getArchitecture"))
+            micro("getArchitecture (4 KiB)", sources, [](const std::string& source) { doNotOptimize(getArchitecture(source)); });
+        std::printf("\n");
+    }
+
+    void endToEnd(const std::vector<size_t>& sizes, unsigned jobs, std::string_view filter) {
+        std::unique_ptr<parallel::ThreadPool> pool;
+        if (jobs > 1) pool = std::make_unique<parallel::ThreadPool>(jobs);
+
+        std::printf("%-28s %10s %8s %14s %10s\n", "end-to-end", "size", "threads", "lines/s", "MB/s");
+        for (size_t size : sizes) {
+            for (corpus::Style style : {corpus::GCC, corpus::NASM, corpus::DATA}) {
+                std::string name = "writeAnalysis/" + std::string(corpus::STYLE_NAMES[style]);
+                if (name.find(filter) == std::string::npos) continue;
+
+                std::string source = corpus::Generator(style).generate(size);
+                double count = static_cast<double>(std::count(source.begin(), source.end(), '\n'));
+                double megabytes = static_cast<double>(source.size()) / (1024.0 * 1024.0);
+
+                // Sequentially, then on the pool (if there is one)
+                std::vector<parallel::ThreadPool*> runs = {nullptr};
+                if (pool != nullptr) runs.push_back(pool.get());
+                for (parallel::ThreadPool* threads : runs) {
+                    auto begin = Clock::now();
+                    writeAnalysis(source, "/dev/null", threads);
+                    double elapsed = seconds(begin);
+                    std::printf("%-28s %9.1fM %8zu %14.0f %10.1f\n", name.c_str(), megabytes,
+                                threads == nullptr ? size_t{1} : threads->size(), count / elapsed, megabytes / elapsed);
+                }
+            }
+        }
+    }
+
+    /**
+     * Streams a corpus of at least `size` bytes to `path`, one megabyte at a time.
+     */
+    void generate(corpus::Style style, size_t size, const std::string& path) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) dbg::Misc::fexit("Cannot open " + path);
+
+        corpus::Generator generator(style);
+        std::string block;
+        size_t written = 0;
+        while (written < size) {
+            block.clear();
+            while (block.size() < (1 << 20) && written + block.size() < size) generator.next(block);
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+            written += block.size();
+        }
+        if (!out.flush()) dbg::Misc::fexit("Cannot write " + path);
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    dbg::Misc::pauseOnExit = false;
+
+    std::vector<size_t> sizes = {1 << 20, 16 << 20};
+    unsigned jobs = parallel::defaultJobs();
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            std::string_view list = argv[++i];
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                size_t size = parseSize(list.substr(0, comma));
+                if (size == 0) dbg::Misc::fexit("Invalid size in --sizes: " + std::string(list.substr(0, comma)));
+                sizes.push_back(size);
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            }
+        } else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+            unsigned value = 0;
+            std::string_view text = argv[++i];
+            auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (ec != std::errc() || end != text.data() + text.size() || value == 0)
+                dbg::Misc::fexit("Invalid --jobs value: " + std::string(text));
+            jobs = value;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--generate" && i + 3 < argc) {
+            std::optional<corpus::Style> style = parseStyle(argv[i + 1]);
+            size_t size = parseSize(argv[i + 2]);
+            if (!style || size == 0) dbg::Misc::fexit("Usage: --generate gcc|nasm|data SIZE FILE");
+            generate(*style, size, argv[i + 3]);
+            return 0;
+        } else if (arg == "-h" || arg == "--help") {
+            std::cout << USAGE;
+            return 0;
+        } else {
+            dbg::Misc::fexit("Unknown argument: " + std::string(arg) + "\n\n" + USAGE);
+        }
+    }
+
+    microbenchmarks(filter);
+    endToEnd(sizes, jobs, filter);
+    return 0;
+}
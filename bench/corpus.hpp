@@ -0,0 +1,235 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <array>
+
+/**
+ * A namespace for generating synthetic assembly corpora.
+ *
+ * The output only depends on the style and the seed, so benchmark runs on
+ * different machines analyze the same bytes.
+ */
+namespace corpus {
+    /**
+     * Enumerates the generated flavours.
+     */
+    enum Style : uint8_t {
+        /**
+         * GCC/Clang AT&T output: tab-indented, many local labels and directives.
+         */
+        GCC,
+        /**
+         * Hand-written NASM-style Intel syntax: space-indented, comma-separated operands.
+         */
+        NASM,
+        /**
+         * Directive-heavy data sections (tables, strings, alignment).
+         */
+        DATA
+    };
+
+    inline constexpr std::array<std::string_view, DATA + 1> STYLE_NAMES = {"gcc", "nasm", "data"};
+
+    /**
+     * A small, fully specified PRNG (splitmix64).
+     */
+    class Random {
+    public:
+        explicit Random(uint64_t seed) : state_(seed) {}
+
+        auto next() -> uint64_t {
+            uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @return A value in [0, n).
+         */
+        auto below(uint64_t n) -> uint64_t { return next() % n; }
+
+        template <typename T, size_t N>
+        auto pick(const std::array<T, N>& items) -> const T& { return items[below(N)]; }
+
+    private:
+        uint64_t state_;
+    };
+
+    /**
+     * Produces a corpus one function (or data block) at a time.
+     */
+    class Generator {
+    public:
+        explicit Generator(Style style, uint64_t seed = 1) : style_(style), random_(seed) {}
+
+        /**
+         * Appends the next block of lines to `out`.
+         */
+        void next(std::string& out) {
+            switch (style_) {
+            case GCC:
+                gccFunction(out);
+                break;
+            case NASM:
+                nasmFunction(out);
+                break;
+            case DATA:
+                dataBlock(out);
+                break;
+            }
+            ++blocks_;
+        }
+
+        /**
+         * @return A corpus of at least `size` bytes (cut at a line boundary past it).
+         */
+        auto generate(size_t size) -> std::string {
+            std::string out;
+            out.reserve(size + 4096);
+            while (out.size() < size) next(out);
+            return out;
+        }
+
+    private:
+        static constexpr std::array<std::string_view, 8> GPR64 = {"%rax", "%rbx", "%rcx", "%rdx", "%rsi", "%rdi", "%r8", "%r12"};
+        static constexpr std::array<std::string_view, 6> GPR32 = {"%eax", "%ebx", "%ecx", "%edx", "%esi", "%edi"};
+        static constexpr std::array<std::string_view, 8> INTEL = {"rax", "rbx", "rcx", "rdx", "rsi", "rdi", "r8", "r12"};
+        static constexpr std::array<std::string_view, 6> ATT_BINARY = {"movq", "addq", "subq", "cmpq", "xorq", "andq"};
+        static constexpr std::array<std::string_view, 5> INTEL_BINARY = {"mov", "add", "sub", "cmp", "xor"};
+        static constexpr std::array<std::string_view, 4> JUMPS = {"jmp", "je", "jne", "jg"};
+
+        void line(std::string& out, std::string_view indent, std::string_view text) {
+            out += indent;
+            out += text;
+            out += '\n';
+        }
+
+        auto number() -> std::string { return std::to_string(random_.below(4096)); }
+
+        auto function() -> std::string { return "fn" + std::to_string(blocks_); }
+
+        void gccFunction(std::string& out) {
+            std::string name = function();
+            if (blocks_ == 0) {
+                line(out, "\t", ".file\t\"generated.c\"");
+                line(out, "\t", ".text");
+            }
+            line(out, "\t", ".globl\t" + name);
+            line(out, "\t", ".type\t" + name + ", @function");
+            line(out, "", name + ":");
+            line(out, "", ".LFB" + std::to_string(blocks_) + ":");
+            line(out, "\t", ".cfi_startproc");
+            line(out, "\t", "pushq\t%rbp");
+            line(out, "\t", "movq\t%rsp, %rbp");
+
+            uint64_t blocks = 1 + random_.below(4);
+            for (uint64_t b = 0; b < blocks; ++b) {
+                uint64_t body = 3 + random_.below(10);
+                for (uint64_t i = 0; i < body; ++i) {
+                    switch (random_.below(6)) {
+                    case 0:
+                        line(out, "\t", "movl\t$" + number() + ", -" + std::to_string(4 * (1 + random_.below(8))) + "(%rbp)");
+                        break;
+                    case 1:
+                        line(out, "\t", "movl\t-" + std::to_string(4 * (1 + random_.below(8))) + "(%rbp), " + std::string(random_.pick(GPR32)));
+                        break;
+                    case 2:
+                        line(out, "\t", "call\tfn" + std::to_string(random_.below(blocks_ + 1)));
+                        break;
+                    default:
+                        line(out, "\t", std::string(random_.pick(ATT_BINARY)) + "\t" + std::string(random_.pick(GPR64)) + ", " + std::string(random_.pick(GPR64)));
+                        break;
+                    }
+                }
+                std::string label = ".L" + std::to_string(blocks_) + "_" + std::to_string(b);
+                line(out, "\t", std::string(random_.pick(JUMPS)) + "\t" + label);
+                line(out, "", label + ":");
+            }
+
+            line(out, "\t", "popq\t%rbp");
+            line(out, "\t", "ret");
+            line(out, "\t", ".cfi_endproc");
+            line(out, "\t", ".size\t" + name + ", .-" + name);
+        }
+
+        void nasmFunction(std::string& out) {
+            std::string name = function();
+            if (blocks_ == 0) {
+                line(out, "", "BITS 64");
+                line(out, "", "section .text");
+            }
+            line(out, "", "global " + name);
+            line(out, "", name + ":");
+            line(out, "    ", "push rbp");
+            line(out, "    ", "mov rbp, rsp");
+
+            uint64_t body = 4 + random_.below(20);
+            for (uint64_t i = 0; i < body; ++i) {
+                switch (random_.below(8)) {
+                case 0:
+                    line(out, "    ", "mov " + std::string(random_.pick(INTEL)) + ", " + number());
+                    break;
+                case 1:
+                    line(out, "    ", "mov [rbp-" + std::to_string(8 * (1 + random_.below(8))) + "], " + std::string(random_.pick(INTEL)));
+                    break;
+                case 2:
+                    line(out, "    ", "call fn" + std::to_string(random_.below(blocks_ + 1)));
+                    break;
+                case 3:
+                    line(out, "    ", "inc " + std::string(random_.pick(INTEL)));
+                    break;
+                case 4:
+                    line(out, "    ", "cmp " + std::string(random_.pick(INTEL)) + " " + number());
+                    line(out, "    ", "jne " + name + "_done");
+                    break;
+                case 5:
+                    line(out, "    ", "int 0x80");
+                    break;
+                default:
+                    line(out, "    ", std::string(random_.pick(INTEL_BINARY)) + " " + std::string(random_.pick(INTEL)) + ", " + std::string(random_.pick(INTEL)));
+                    break;
+                }
+            }
+
+            line(out, "", name + "_done:");
+            line(out, "    ", "pop rbp");
+            line(out, "    ", "ret");
+            line(out, "", "");
+        }
+
+        void dataBlock(std::string& out) {
+            std::string name = "table" + std::to_string(blocks_);
+            line(out, "    ", ".data");
+            line(out, "    ", ".align 8");
+            line(out, "    ", ".globl " + name);
+            line(out, "", name + ":");
+
+            uint64_t rows = 4 + random_.below(28);
+            for (uint64_t i = 0; i < rows; ++i) {
+                switch (random_.below(5)) {
+                case 0:
+                    line(out, "    ", ".byte " + number() + ", " + number() + ", " + number() + ", " + number());
+                    break;
+                case 1:
+                    line(out, "    ", ".word " + number());
+                    break;
+                case 2:
+                    line(out, "    ", ".string \"entry " + number() + "\"");
+                    break;
+                default:
+                    line(out, "    ", ".quad " + number());
+                    break;
+                }
+            }
+            line(out, "    ", ".section .rodata");
+            line(out, "    ", ".comm buffer" + std::to_string(blocks_) + "," + number());
+        }
+
+        Style style_;
+        Random random_;
+        uint64_t blocks_ = 0;
+    };
+} // namespace corpus
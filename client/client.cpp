@@ -0,0 +1,103 @@
+// A thin client for `asm-analyze --serve`: it only talks to the daemon, so starting it
+// costs none of the analyzer's setup.
+
+#include <dbg.hpp>
+#include <serve.hpp>
+
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const std::string USAGE =
+        "Usage: asm-analyze-client SOCKET [options] path...\n"
+        "\n"
+        "Has the daemon started with `asm-analyze --serve SOCKET` analyze each path, like\n"
+        "`asm-analyze path` would, or stdin ('-'), whose annotated text is printed.\n"
+        "\n"
+        "Options:\n"
+        "  -o, --output FILE  Write the analyzed file to FILE; single input only\n"
+        "  -h, --help         Show this help\n";
+
+    /**
+     * Sends a request and handles the reply.
+     *
+     * @return The error reported by the daemon, or "" on success.
+     */
+    [[nodiscard]] auto request(const std::string& socketPath, std::string_view header, std::string_view payload) -> std::string {
+        serve::Descriptor connection = serve::connect(socketPath);
+        if (!connection) return "Cannot connect to " + socketPath + ": " + std::strerror(errno);
+
+        // The daemon answers a BUFFER while it still reads it, so the request is sent
+        // from another thread; waiting for the whole of it first could fill both sockets
+        bool sent = false;
+        std::jthread sender([&] { sent = serve::writeAll(connection.get(), header) && serve::writeAll(connection.get(), payload); });
+
+        serve::Reader reader(connection.get());
+        std::string reply;
+        if (!reader.line(reply, static_cast<size_t>(64) << 10)) return "Connection lost";
+        if (reply.rfind(serve::ERROR_REPLY, 0) == 0) return reply.substr(serve::ERROR_REPLY.size());
+        if (reply + '\n' != serve::OK_REPLY) return "Unexpected reply: " + reply;
+
+        // Only BUFFER replies carry text
+        bool complete = reader.drain([](std::string_view text) { std::cout.write(text.data(), static_cast<std::streamsize>(text.size())); });
+        std::cout.flush();
+        sender.join();
+        return complete && sent ? "" : "Connection lost";
+    }
+
+    [[nodiscard]] auto absolute(const std::string& path) -> std::string {
+        std::error_code ec;
+        std::filesystem::path resolved = std::filesystem::absolute(path, ec);
+        return ec ? path : resolved.string();
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    dbg::Misc::pauseOnExit = false;
+    dbg::Debugger::output = &std::cerr;
+
+    std::string socketPath;
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << USAGE;
+            return 0;
+        } else if ((arg == "--output" || arg == "-o") && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg.rfind("--output=", 0) == 0) {
+            output = arg.substr(9);
+        } else if (arg != "-" && arg[0] == '-') {
+            dbg::Misc::fexit("Unknown argument: " + std::string(arg) + "\n\n" + USAGE);
+        } else if (socketPath.empty()) {
+            socketPath = arg;
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (socketPath.empty() || inputs.empty()) dbg::Misc::fexit("Missing socket or path\n\n" + USAGE);
+    if (!output.empty() && (inputs.size() > 1 || inputs[0] == "-")) dbg::Misc::fexit("--output needs a single file input");
+
+    int status = 0;
+    for (const std::string& input : inputs) {
+        std::string error;
+        if (input == "-") {
+            std::string source((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+            error = request(socketPath, std::string(serve::BUFFER_REQUEST) + std::to_string(source.size()) + '\n', source);
+        } else {
+            std::string header = std::string(serve::FILE_REQUEST) + absolute(input);
+            if (!output.empty()) header += '\t' + absolute(output);
+            error = request(socketPath, header + '\n', {});
+        }
+        if (!error.empty()) {
+            dbg::Macros::error(input + ": " + error);
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,1191 @@
+#include <include.h>
+
+constexpr size_t CHUNK_SIZE = static_cast<size_t>(1) << 20; // bytes of input per parallel work item
+
+struct AnalyzedChunk {
+    std::string text;
+    uint64_t lines = 0;
+    std::vector<xref::Event> events; // only collected for a cross-reference or a control-flow graph
+    columnar::Columns columns; // only filled for columnar output (instead of the text)
+};
+
+auto analyzeFile(const std::string& filename, parallel::ThreadPool* pool, const std::string& output, cache::Store* store, bool crossReference, cfg::Format graph, bool columnar) -> size_t {
+    stats::start();
+    io::InputFile originalFile(filename);
+    stats::lap(stats::READ);
+    if (!originalFile) {
+        throw std::runtime_error("File not found: " + filename);
+    }
+
+    compression::Codec inputCodec = compression::codecOf(filename);
+    compression::Codec outputCodec = output.empty() || output == "-" ? compression::output : compression::codecOf(output);
+    if (columnar && outputCodec != compression::NONE)
+        throw std::runtime_error("Columnar output cannot be compressed");
+
+    // A compressed input is named after the file inside it
+    std::string nfilename = output;
+    if (nfilename.empty()) {
+        nfilename = compression::strip(filename);
+        size_t dotPos = nfilename.find_last_of('.');
+        if (dotPos != std::string::npos) {
+            nfilename.insert(dotPos, "_analyzed");
+            if (columnar) nfilename.replace(dotPos + 9, std::string::npos, ".col");
+        } else {
+            nfilename += "_analyzed";
+            if (columnar) nfilename += ".col";
+        }
+        nfilename += compression::EXTENSIONS[outputCodec];
+    }
+
+    // Extensions of the files written next to the output
+    bool toFile = nfilename != "-";
+    std::vector<std::string_view> sidecars;
+    if (toFile && crossReference) sidecars.emplace_back(".xref");
+    if (toFile && graph != cfg::NONE) sidecars.push_back(cfg::EXTENSIONS[graph]);
+    bool incremental = incremental::enabled && toFile && !columnar && !crossReference && graph == cfg::NONE && outputCodec == compression::NONE;
+    if (incremental) sidecars.push_back(incremental::EXTENSION);
+
+    // A compressed input is decompressed while it is analyzed, unless the whole source is
+    // needed at once (by the columnar output, --incremental or --includes)
+    bool whole = columnar || incremental || (includes::follow && crossReference);
+    bool streamed = inputCodec != compression::NONE && !whole;
+    std::string inflated;
+    auto source = [&]() -> std::string_view {
+        if (inputCodec == compression::NONE) return originalFile.view();
+        if (inflated.empty()) inflated = compression::decompress(inputCodec, originalFile.view());
+        return inflated;
+    };
+
+    // The included headers only add to the cross-reference
+    std::vector<std::shared_ptr<const includes::Header>> headers;
+    if (includes::follow && crossReference) headers = collectIncludes(source(), filename);
+
+    // Columnar outputs embed the absolute source path
+    std::string sourcePath;
+    if (columnar) {
+        std::error_code ec;
+        sourcePath = std::filesystem::absolute(filename, ec).string();
+        if (ec) sourcePath = filename;
+    }
+
+    // Unchanged inputs are served from the cache
+    std::string key;
+    if (store != nullptr && toFile) {
+        key = store->key(originalFile.view(), sourcePath);
+        if (columnar) key += ".col" + std::to_string(columnar::VERSION);
+        if (!headers.empty()) key += ".inc" + std::to_string(includes::fingerprint(headers));
+        if (inputCodec != compression::NONE || outputCodec != compression::NONE) key += ".z" + std::to_string(inputCodec) + std::to_string(outputCodec);
+        bool restored = store->restore(key, nfilename);
+        for (std::string_view extension : sidecars) {
+            if (restored) restored = store->restore(key + std::string(extension), nfilename + std::string(extension));
+        }
+        if (restored) {
+            ++stats::totals().files;
+            ++stats::totals().cached;
+            return originalFile.view().size();
+        }
+    }
+
+    // Files are written next to their destination and renamed into place, which
+    // never disturbs a cache entry the previous output was linked to
+    std::vector<std::string> targets = {toFile ? cache::temporaryName(nfilename).string() : nfilename};
+    for (std::string_view extension : sidecars) targets.push_back(cache::temporaryName(nfilename + std::string(extension)).string());
+    auto discard = [&targets, toFile]() {
+        std::error_code ec;
+        for (size_t i = toFile ? 0 : 1; i < targets.size(); ++i) std::filesystem::remove(targets[i], ec);
+    };
+
+    std::unique_ptr<xref::Index> index;
+    if (crossReference) index = std::make_unique<xref::Index>();
+    for (const std::shared_ptr<const includes::Header>& header : headers) index->include(header->events, header->path);
+    std::unique_ptr<cfg::Builder> builder;
+    if (graph != cfg::NONE && toFile) builder = std::make_unique<cfg::Builder>();
+    incremental::Index chunks;
+    try {
+        if (columnar) {
+            writeColumnar(source(), targets[0], sourcePath, pool, index.get(), builder.get());
+        } else if (incremental) {
+            writeIncremental(source(), nfilename, targets[0], pool, chunks);
+        } else if (streamed) {
+            std::unique_ptr<io::Reader> in = compression::reader(inputCodec, originalFile.view());
+            writeAnalysis(*in, targets[0], pool, index.get(), builder.get(), outputCodec);
+        } else {
+            writeAnalysis(source(), targets[0], pool, index.get(), builder.get(), outputCodec);
+        }
+        for (size_t i = 0; i < sidecars.size(); ++i) {
+            io::OutputFile file(targets[i + 1]);
+            if (!file) throw std::runtime_error("Cannot open " + nfilename + std::string(sidecars[i]));
+            std::string text;
+            if (sidecars[i] == ".xref") index->write(text);
+            else if (sidecars[i] == incremental::EXTENSION) chunks.write(text);
+            else builder->write(graph, text);
+            file.write(std::move(text));
+            file.close();
+        }
+    } catch (...) {
+        discard();
+        throw;
+    }
+
+    if (toFile) {
+        std::error_code ec;
+        std::filesystem::rename(targets[0], nfilename, ec);
+        for (size_t i = 0; !ec && i < sidecars.size(); ++i)
+            std::filesystem::rename(targets[i + 1], nfilename + std::string(sidecars[i]), ec);
+        if (ec) {
+            discard();
+            throw std::runtime_error("Cannot write " + nfilename);
+        }
+        if (store != nullptr) {
+            store->publish(key, nfilename);
+            for (std::string_view extension : sidecars) store->publish(key + std::string(extension), nfilename + std::string(extension));
+        }
+    }
+    ++stats::totals().files;
+    return originalFile.view().size();
+}
+
+void writeAnalysis(std::string_view source, const std::string& nfilename, parallel::ThreadPool* pool, xref::Index* index, cfg::Builder* graph, compression::Codec codec) {
+    io::OutputFile newFile(nfilename);
+    if (!newFile)
+        throw std::runtime_error("Cannot open " + nfilename);
+    writeAnalysis(source, newFile, pool, index, graph, codec);
+
+    // Without a file to put it next to, the cross-reference becomes an appendix
+    if (index != nullptr && nfilename == "-") writeAppendix(newFile, *index, codec);
+
+    newFile.close();
+    stats::flush();
+}
+
+void writeAnalysis(io::Reader& in, const std::string& nfilename, parallel::ThreadPool* pool, xref::Index* index, cfg::Builder* graph, compression::Codec codec) {
+    io::OutputFile newFile(nfilename);
+    if (!newFile)
+        throw std::runtime_error("Cannot open " + nfilename);
+    analyzeStream(in, newFile, pool, index, graph, codec);
+    if (index != nullptr && nfilename == "-") writeAppendix(newFile, *index, codec);
+    newFile.close();
+}
+
+void writeAppendix(io::OutputFile& out, const xref::Index& index, compression::Codec codec) {
+    std::string appendix = "\n";
+    index.write(appendix);
+    out.write(compression::frame(codec, std::move(appendix)));
+}
+
+auto writeAnalysis(std::string_view source, io::OutputFile& newFile, parallel::ThreadPool* pool, xref::Index* index, cfg::Builder* graph, compression::Codec codec) -> arch::Isa {
+    // The architecture picks the backend every chunk is analyzed with, so it is known
+    // before the first one starts; only the first arch::PREFIX bytes are scanned
+    arch::Isa architecture = arch::detect(source);
+    std::string header;
+    writeHeader(header, arch::name(architecture));
+    newFile.write(compression::frame(codec, std::move(header)));
+    uint64_t line = 1;
+
+    // Results are written back in input order; each is compressed by the worker that analyzed it
+    size_t window = pool == nullptr ? 1 : pool->size() * 2;
+    parallel::orderedMap(pool, parallel::splitLines(source, CHUNK_SIZE),
+        [architecture, codec, collect = index != nullptr || graph != nullptr](std::string_view chunk) {
+            AnalyzedChunk result;
+            result.lines = analyzeChunk(chunk, result.text, architecture, collect ? &result.events : nullptr);
+            result.text = compression::frame(codec, std::move(result.text));
+            return result;
+        },
+        [&](AnalyzedChunk&& result) {
+            stats::Scope scope(stats::WRITE);
+            if (index != nullptr) index->add(result.events, line);
+            if (graph != nullptr) graph->add(result.events, line, result.lines);
+            line += result.lines;
+            newFile.write(std::move(result.text));
+        },
+        window);
+    return architecture;
+}
+
+void writeIncremental(std::string_view source, const std::string& previous, const std::string& nfilename, parallel::ThreadPool* pool, incremental::Index& chunks) {
+    arch::Isa architecture = arch::detect(source);
+
+    // The previous output and its index, if they still belong together
+    io::InputFile previousFile(previous);
+    std::string_view previousOutput = previousFile ? previousFile.view() : std::string_view();
+    incremental::Index known = incremental::Index::load(previous + std::string(incremental::EXTENSION));
+    if (!known.matches(previousOutput, core::VERSION, architecture)) known = incremental::Index();
+
+    io::OutputFile newFile(nfilename);
+    if (!newFile)
+        throw std::runtime_error("Cannot open " + nfilename);
+    chunks.version = core::VERSION;
+    chunks.architecture = architecture;
+    writeHeader(chunks.header, arch::name(architecture));
+    newFile.write(chunks.header);
+
+    struct Spliced {
+        AnalyzedChunk analyzed;
+        const incremental::Entry* reused = nullptr;
+    };
+
+    // Known chunks are copied from the previous output; only the others are analyzed
+    uint64_t reused = 0;
+    std::vector<incremental::Chunk> inputs = incremental::split(source);
+    size_t window = pool == nullptr ? 1 : pool->size() * 2;
+    parallel::orderedMap(pool, inputs,
+        [&known, architecture](const incremental::Chunk& chunk) {
+            Spliced result;
+            result.reused = known.find(chunk);
+            if (result.reused == nullptr) result.analyzed.lines = analyzeChunk(chunk.text, result.analyzed.text, architecture);
+            return result;
+        },
+        [&](Spliced&& result) {
+            stats::Scope scope(stats::WRITE);
+            const incremental::Chunk& chunk = inputs[chunks.entries.size()];
+            incremental::Entry entry {chunk.hash, chunk.text.size(), newFile.position(), 0, result.analyzed.lines};
+            if (result.reused != nullptr) {
+                entry.outputSize = result.reused->outputSize;
+                entry.lines = result.reused->lines;
+                newFile.write(previousOutput.substr(result.reused->outputOffset, result.reused->outputSize));
+                ++reused;
+            } else {
+                entry.outputSize = result.analyzed.text.size();
+                newFile.write(std::move(result.analyzed.text));
+            }
+            chunks.entries.push_back(entry);
+        },
+        window);
+    chunks.outputSize = newFile.position();
+    newFile.close();
+
+    // analyzeChunk() only counts the lines it analyzed
+    stats::Totals& run = stats::totals();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const incremental::Entry& entry = chunks.entries[i];
+        if (known.find(inputs[i]) == nullptr) continue;
+        run.lines += entry.lines;
+        run.bytes += entry.inputSize;
+    }
+    run.chunksReused += reused;
+    run.chunksAnalyzed += inputs.size() - reused;
+    stats::flush();
+}
+
+void writeColumnar(std::string_view source, const std::string& nfilename, std::string_view path, parallel::ThreadPool* pool, xref::Index* index, cfg::Builder* graph) {
+    io::OutputFile newFile(nfilename);
+    if (!newFile)
+        throw std::runtime_error("Cannot open " + nfilename);
+    writeColumnar(source, newFile, path, pool, index, graph);
+    newFile.close();
+    stats::flush();
+}
+
+auto writeColumnar(std::string_view source, io::OutputFile& newFile, std::string_view path, parallel::ThreadPool* pool, xref::Index* index, cfg::Builder* graph) -> arch::Isa {
+    // The columns are kept until the end, since the header counts the lines
+    arch::Isa architecture = arch::detect(source);
+    uint64_t line = 1;
+    columnar::Writer writer;
+
+    size_t window = pool == nullptr ? 1 : pool->size() * 2;
+    parallel::orderedMap(pool, parallel::splitLines(source, CHUNK_SIZE),
+        [architecture, source, collect = index != nullptr || graph != nullptr](std::string_view chunk) {
+            AnalyzedChunk result;
+            result.columns.base = static_cast<uint64_t>(chunk.data() - source.data());
+            result.lines = analyzeChunk(chunk, result.text, architecture, collect ? &result.events : nullptr, &result.columns);
+            return result;
+        },
+        [&](AnalyzedChunk&& result) {
+            stats::Scope scope(stats::WRITE);
+            if (index != nullptr) index->add(result.events, line);
+            if (graph != nullptr) graph->add(result.events, line, result.lines);
+            line += result.lines;
+            writer.add(std::move(result.columns));
+        },
+        window);
+
+    stats::Scope scope(stats::WRITE);
+    writer.write(newFile, architecture, source, path);
+    return architecture;
+}
+
+auto convertColumnar(const std::string& filename, const std::string& source, const std::string& output) -> uint64_t {
+    io::InputFile file(filename);
+    if (!file)
+        throw std::runtime_error("File not found: " + filename);
+    columnar::Reader reader(file.view());
+    if (!reader)
+        throw std::runtime_error(filename + ": " + reader.error());
+
+    std::string sourcePath = source.empty() ? std::string(reader.sourcePath()) : source;
+    io::InputFile original(sourcePath);
+    if (!original)
+        throw std::runtime_error("Source not found: " + sourcePath);
+    compression::Codec codec = compression::codecOf(sourcePath);
+    std::string inflated = codec == compression::NONE ? std::string() : compression::decompress(codec, original.view());
+    std::string_view contents = codec == compression::NONE ? original.view() : std::string_view(inflated);
+    if (!reader.matches(contents))
+        throw std::runtime_error(sourcePath + " is not the source " + filename + " was made from");
+
+    io::OutputFile out(output);
+    if (!out)
+        throw std::runtime_error("Cannot open " + output);
+
+    std::string text;
+    writeHeader(text, arch::name(reader.architecture()));
+    isa::dispatch(reader.architecture(), [&](auto backend) {
+        for (uint64_t i = 0; i < reader.lines(); ++i) {
+            text += reader.line(i, contents);
+            if (reader.kind(i) != analysis::BLANK) {
+                text += "\t\t; ";
+                formatComment<decltype(backend)>(reader.record(i, contents), text);
+            }
+            text += '\n';
+            if (text.size() >= CHUNK_SIZE) {
+                out.write(std::move(text));
+                text = std::string();
+            }
+        }
+    });
+    out.write(std::move(text));
+    out.close();
+    return reader.lines();
+}
+
+auto analyzeStream(io::Reader& in, io::OutputFile& out, parallel::ThreadPool* pool, xref::Index* index, cfg::Builder* graph, compression::Codec codec) -> size_t {
+    // Complete lines are analyzed one buffer at a time; a partial last line is carried over
+    // to the next read. The buffer only grows for a single line longer than itself.
+    std::string buffer(CHUNK_SIZE * (pool == nullptr ? 1 : pool->size()), '\0');
+    size_t filled = 0;
+    size_t total = 0;
+    bool headerWritten = false;
+    arch::Isa architecture = arch::UNKNOWN;
+    uint64_t line = 1;
+
+    for (bool eof = false; !eof;) {
+        stats::start();
+        size_t wanted = buffer.size() - filled;
+        size_t got = in.read(buffer.data() + filled, wanted);
+        stats::lap(stats::READ);
+        filled += got;
+        total += got;
+        eof = got < wanted;
+
+        std::string_view data(buffer.data(), filled);
+        size_t end = eof ? filled : data.rfind('\n') + 1; // npos + 1 == 0
+        if (end == 0) {
+            buffer.resize(buffer.size() * 2);
+            continue;
+        }
+
+        // The first buffer holds the whole detection prefix (or the whole stream), so the
+        // architecture named in the header is the one a file with these bytes gets
+        static_assert(arch::PREFIX <= CHUNK_SIZE);
+        if (!headerWritten) {
+            architecture = arch::detect(data);
+            std::string header;
+            writeHeader(header, arch::name(architecture));
+            out.write(compression::frame(codec, std::move(header)));
+            headerWritten = true;
+        }
+
+        size_t window = pool == nullptr ? 1 : pool->size() * 2;
+        parallel::orderedMap(pool, parallel::splitLines(data.substr(0, end), CHUNK_SIZE),
+            [architecture, codec, collect = index != nullptr || graph != nullptr](std::string_view chunk) {
+                AnalyzedChunk result;
+                result.lines = analyzeChunk(chunk, result.text, architecture, collect ? &result.events : nullptr);
+                result.text = compression::frame(codec, std::move(result.text));
+                return result;
+            },
+            [&](AnalyzedChunk&& result) {
+                stats::Scope scope(stats::WRITE);
+                if (index != nullptr) index->add(result.events, line);
+                if (graph != nullptr) graph->add(result.events, line, result.lines);
+                line += result.lines;
+                out.write(std::move(result.text));
+            },
+            window);
+
+        stats::start();
+        out.flush();
+        stats::lap(stats::WRITE);
+
+        std::memmove(buffer.data(), buffer.data() + end, filled - end);
+        filled -= end;
+    }
+
+    stats::flush();
+    return total;
+}
+
+auto core::analyze(const Unit& unit, const Options& options, unsigned jobs) -> Result {
+    Result result;
+    try {
+        std::unique_ptr<parallel::ThreadPool> pool;
+        if (jobs > 1) pool = std::make_unique<parallel::ThreadPool>(jobs);
+        std::unique_ptr<xref::Index> index;
+        if (options.crossReference) index = std::make_unique<xref::Index>();
+        if (index != nullptr && options.includes) {
+            for (const std::shared_ptr<const includes::Header>& header : collectIncludes(unit.source, unit.name))
+                index->include(header->events, header->path);
+        }
+        std::unique_ptr<cfg::Builder> builder;
+        if (options.graph != cfg::NONE) builder = std::make_unique<cfg::Builder>();
+
+        io::OutputFile out(&result.output);
+        arch::Isa architecture = options.format == COLUMNAR
+            ? writeColumnar(unit.source, out, unit.name, pool.get(), index.get(), builder.get())
+            : writeAnalysis(unit.source, out, pool.get(), index.get(), builder.get());
+        out.close();
+        result.architecture = arch::name(architecture);
+        if (index != nullptr) index->write(result.crossReference);
+        if (builder != nullptr) builder->write(options.graph, result.graph);
+        ++stats::totals().files;
+    } catch (const std::exception& e) {
+        result = Result();
+        result.error = unit.name.empty() ? e.what() : unit.name + ": " + e.what();
+    }
+    stats::flush();
+    return result;
+}
+
+auto core::analyzeBatch(const std::vector<Unit>& units, const Options& options, unsigned jobs) -> std::vector<Result> {
+    // Largest units first, like the files of a directory
+    std::vector<size_t> order(units.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&units](size_t a, size_t b) { return units[a].source.size() > units[b].source.size(); });
+
+    std::vector<Result> results(units.size());
+    parallel::stealingForEach(order, jobs == 0 ? parallel::defaultJobs() : jobs,
+        [&](size_t i) { results[i] = analyze(units[i], options); });
+    return results;
+}
+
+auto loadHeader(const std::string& path) -> std::shared_ptr<const includes::Header> {
+    io::InputFile file(path);
+    if (!file) return nullptr;
+
+    auto header = std::make_shared<includes::Header>();
+    header->path = path;
+    header->source = std::string(file.view());
+    header->hash = hash::xxh64(header->source);
+
+    // One pass over the whole header; only its symbols are kept
+    std::string text;
+    uint64_t lines = analyzeChunk(header->source, text, arch::detect(header->source), &header->events);
+    stats::totals().lines -= lines; // counted as includes, not as the lines of the analyzed files
+    stats::totals().bytes -= header->source.size();
+
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    for (const includes::Directive& directive : includes::scan(header->source)) {
+        std::string resolved = includes::resolve(directive.path, directory);
+        if (!resolved.empty()) header->includes.push_back(std::move(resolved));
+    }
+    return header;
+}
+
+auto collectIncludes(std::string_view source, const std::string& filename) -> std::vector<std::shared_ptr<const includes::Header>> {
+    return includes::collect(source, std::filesystem::path(filename).parent_path(), loadHeader);
+}
+
+auto writeHeader(std::string& header, std::string_view architecture) -> size_t {
+    std::ostringstream out;
+    out << "; INFORMATION:" << '\n';
+    out << "; \tAssembly Analyzer Version: " << core::VERSION << '\n';
+    auto now = std::chrono::system_clock::now();
+    std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
+    struct tm localTime {};
+#if defined(_WIN32) || defined (_WIN64)
+    localtime_s(&localTime, &currentTime);
+#else
+    localtime_r(&currentTime, &localTime);
+#endif
+    out << "; \tAnalyzed on: " << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S") << '\n';
+    out << "; \tInstruction Set Architecture: ";
+    header += out.str();
+    size_t field = header.size();
+    header += architecture;
+    header += "\n\n";
+    return field;
+}
+
+auto analyzeChunk(std::string_view chunk, std::string& out, arch::Isa architecture, std::vector<xref::Event>* events, columnar::Columns* columns) -> uint64_t {
+    return isa::dispatch(architecture, [&](auto backend) { return analyzeChunk<decltype(backend)>(chunk, out, events, columns); });
+}
+
+template <typename Backend>
+auto analyzeChunk(std::string_view chunk, std::string& out, std::vector<xref::Event>* events, columnar::Columns* columns) -> uint64_t {
+    if (columns == nullptr) out.reserve(out.size() + chunk.size() * 3);
+
+    // Operands repeat a lot; they are classified once per chunk. The canonical copies
+    // live in an arena that is released in one shot when the next chunk starts.
+    thread_local intern::Arena arena;
+    thread_local analysis::OperandCache operands(arena);
+    operands.clear();
+    arena.reset();
+
+    // Repeated lines reuse their comment; the records of the other outputs are always parsed
+    thread_local memo::Cache comments;
+    bool memoize = events == nullptr && columns == nullptr;
+    comments.resetCounts();
+
+    scan::Tokenizer lines(chunk);
+    scan::Line tokens;
+    uint64_t count = 0;
+    stats::start();
+    while (lines.next(tokens)) {
+        stats::lap(stats::READ);
+        std::string_view line = tokens.text;
+
+        uint64_t h = 0;
+        bool cacheable = memoize && !tokens.blank && memo::Cache::cacheable(line);
+        if (cacheable) {
+            h = hash::xxh64(line);
+            if (const memo::Entry* entry = comments.find(line, h)) {
+                stats::count(entry->record());
+                out += line;
+                out += "\t\t; ";
+                out += entry->comment();
+                out += '\n';
+                stats::lap(stats::FORMAT);
+                ++count;
+                continue;
+            }
+        }
+
+        analysis::Record record = parseLine<Backend>(tokens, &operands);
+        if (events != nullptr) xref::collect(record, count, *events);
+        stats::lap(stats::CLASSIFY);
+        stats::count(record);
+
+        if (columns != nullptr) {
+            columns->add(record, line, static_cast<uint64_t>(line.data() - chunk.data()));
+            stats::lap(stats::FORMAT);
+            ++count;
+            continue;
+        }
+
+        out += line;
+        if (record.kind != analysis::BLANK) {
+            out += "\t\t; ";
+            size_t begin = out.size();
+            formatComment<Backend>(record, out);
+            if (cacheable) comments.insert(line, h, record, std::string_view(out).substr(begin));
+        }
+        out += '\n';
+        stats::lap(stats::FORMAT);
+        ++count;
+    }
+
+    stats::totals().lines += count;
+    stats::totals().memoHits += comments.hits();
+    stats::totals().memoMisses += comments.misses();
+    stats::totals().bytes += chunk.size();
+    stats::flush();
+    return count;
+}
+
+[[nodiscard]] auto isDirective(std::string_view opcode) -> bool {
+    return !opcode.empty() && opcode[0] == '.';
+}
+
+[[nodiscard]] auto isMemoryAddressingMode(std::string_view operand) -> bool {
+    return isa::X86::memory(operand);
+}
+
+[[nodiscard]] auto operandSpan(std::string_view line) -> std::string_view {
+    size_t wPos = line.find(' ');
+    if (wPos == std::string_view::npos) return {};
+
+    std::string_view operand = line.substr(wPos + 1);
+    size_t trailingWPos = operand.find_last_not_of(' ');
+    if (trailingWPos != std::string_view::npos)
+        operand = operand.substr(0, trailingWPos + 1);
+
+    return operand;
+}
+
+[[nodiscard]] auto getOperand(std::string_view line) -> std::string {
+    return std::string(operandSpan(line));
+}
+
+template <typename Backend>
+[[nodiscard]] auto classifyOperand(std::string_view operand) -> analysis::Operand {
+    analysis::Operand result {operand};
+    if (operand.empty()) return result;
+
+    // Registers are matched case-insensitively
+    if (operand.size() <= Backend::REGISTER_WIDTH) {
+        std::array<char, Backend::REGISTER_WIDTH> lower {};
+        scan::lower(operand, lower.data());
+
+        result.reg = Backend::reg(std::string_view(lower.data(), operand.size()));
+        if (result.reg != nullptr) {
+            result.kind = analysis::REGISTER;
+            return result;
+        }
+    }
+
+    // `8(sp)` starts like an immediate
+    if (Backend::memory(operand)) {
+        result.kind = analysis::MEMORY;
+    } else if (Backend::immediate(operand)) {
+        result.kind = analysis::IMMEDIATE;
+    } else {
+        result.kind = analysis::IDENTIFIER;
+    }
+    return result;
+}
+
+template <typename Backend>
+[[nodiscard]] auto classifyOperand(std::string_view operand, analysis::OperandCache* cache) -> analysis::Operand {
+    if (cache == nullptr || operand.empty()) return classifyOperand<Backend>(operand);
+
+    auto [id, first] = cache->intern(operand);
+    analysis::Classification& known = cache->value(id);
+    if (first) {
+        analysis::Operand result = classifyOperand<Backend>(operand);
+        known = {result.kind, result.reg};
+        return result;
+    }
+    return {operand, known.kind, known.reg};
+}
+
+[[nodiscard]] auto classifyOperand(std::string_view operand) -> analysis::Operand {
+    return classifyOperand<isa::X86>(operand);
+}
+
+[[nodiscard]] auto classifyOperand(std::string_view operand, analysis::OperandCache* cache) -> analysis::Operand {
+    return classifyOperand<isa::X86>(operand, cache);
+}
+
+void parseInstruction(analysis::Record& record, scan::Split split, analysis::OperandCache* cache) {
+    std::string_view operands = record.operands;
+    switch (record.opcode) {
+    case opcodes::INT: {
+        std::string_view vector = operands.substr(0, split.space);
+        if (vector.rfind("0x", 0) == 0) {
+            record.args[0].text = vector;
+            record.argCount = 1;
+        }
+        break;
+    }
+    case opcodes::MOV: case opcodes::MOVQ: case opcodes::ADD: case opcodes::ADDQ: case opcodes::SUB: case opcodes::SUBQ: {
+        size_t commaPos = split.comma;
+        if (commaPos != std::string_view::npos) {
+            record.args[0] = classifyOperand(operands.substr(0, commaPos), cache);
+            record.args[1] = classifyOperand(operands.substr(commaPos + 1), cache);
+            record.argCount = 2;
+        }
+        break;
+    }
+    case opcodes::CMP: case opcodes::MUL: case opcodes::DIV: {
+        size_t spacePos = split.space;
+        record.args[0] = classifyOperand(operands.substr(0, spacePos), cache);
+        record.args[1] = classifyOperand(spacePos == std::string_view::npos ? operands : operands.substr(spacePos + 1), cache);
+        record.argCount = 2;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+[[nodiscard]] auto parseLine(std::string_view line) -> analysis::Record {
+    return parseLine(scan::tokenize(line));
+}
+
+[[nodiscard]] auto parseLine(const scan::Line& tokens, analysis::OperandCache* cache) -> analysis::Record {
+    analysis::Record record;
+    if (tokens.blank) return record;
+
+    std::string_view trimmedLine = tokens.trimmed();
+
+    if (!trimmedLine.empty() && trimmedLine[trimmedLine.size() - 1] == ':') {
+        record.kind = analysis::LABEL;
+        record.name = trimmedLine.substr(0, trimmedLine.size() - 1);
+        return record;
+    }
+
+    record.name = tokens.name();
+
+    record.opcode = opcodes::lookup(record.name);
+    if (record.opcode != opcodes::NONE) {
+        record.kind = analysis::INSTRUCTION;
+        record.operands = tokens.operands();
+        record.operand = tokens.operand();
+        stats::lap(stats::CLASSIFY);
+        parseInstruction(record, tokens.split, cache);
+        stats::lap(stats::OPERANDS);
+        return record;
+    }
+
+    if (isDirective(record.name)) {
+        record.kind = analysis::DIRECTIVE;
+        record.directive = directives::lookup(record.name);
+        record.operands = tokens.operands();
+        record.operand = tokens.operand();
+        return record;
+    }
+
+    record.kind = analysis::UNKNOWN;
+    return record;
+}
+
+template <typename Backend>
+[[nodiscard]] auto parseRiscLine(const scan::Line& tokens, analysis::OperandCache* cache) -> analysis::Record {
+    analysis::Record record;
+    if (tokens.blank) return record;
+
+    // A comment-only line is blank
+    std::string_view line = tokens.text.substr(0, Backend::comment(tokens.text));
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return record;
+    line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+
+    if (line.back() == ':') {
+        record.kind = analysis::LABEL;
+        record.name = line.substr(0, line.size() - 1);
+        return record;
+    }
+
+    size_t nameEnd = line.find_first_of(" \t");
+    record.name = line.substr(0, nameEnd);
+    std::string_view rest;
+    if (nameEnd != std::string_view::npos) {
+        rest = line.substr(nameEnd + 1);
+        rest.remove_prefix(std::min(rest.find_first_not_of(" \t"), rest.size()));
+    }
+
+    // Mnemonics are matched case-insensitively
+    if (record.name.size() <= Backend::MNEMONIC_WIDTH) {
+        std::array<char, Backend::MNEMONIC_WIDTH> lower {};
+        scan::lower(record.name, lower.data());
+        record.opcode = Backend::opcode(std::string_view(lower.data(), record.name.size()));
+    }
+    if (record.opcode != opcodes::NONE) {
+        record.kind = analysis::INSTRUCTION;
+        record.operands = rest;
+        record.operand = rest;
+        stats::lap(stats::CLASSIFY);
+
+        // Split at the top-level commas; the last operand takes whatever is left
+        int depth = 0;
+        size_t begin = 0;
+        for (size_t i = 0; i <= rest.size() && record.argCount < analysis::MAX_ARGS; ++i) {
+            char c = i < rest.size() ? rest[i] : ',';
+            if (c == '(' || c == '[' || c == '{') ++depth;
+            else if (c == ')' || c == ']' || c == '}') --depth;
+            if (c != ',' || depth > 0) continue;
+            if (record.argCount + 1 == analysis::MAX_ARGS) i = rest.size();
+            std::string_view operand = trim(rest.substr(begin, i - begin));
+            if (operand.empty()) break;
+            record.args[record.argCount++] = classifyOperand<Backend>(operand, cache);
+            begin = i + 1;
+        }
+        stats::lap(stats::OPERANDS);
+        return record;
+    }
+
+    if (isDirective(record.name)) {
+        record.kind = analysis::DIRECTIVE;
+        record.directive = directives::lookup(record.name);
+        record.operands = rest;
+        record.operand = rest;
+        return record;
+    }
+
+    record.kind = analysis::UNKNOWN;
+    return record;
+}
+
+template <typename Backend>
+[[nodiscard]] auto parseLine(const scan::Line& tokens, analysis::OperandCache* cache) -> analysis::Record {
+    if constexpr (Backend::RISC) {
+        return parseRiscLine<Backend>(tokens, cache);
+    } else {
+        return parseLine(tokens, cache);
+    }
+}
+
+void appendLower(std::string& out, std::string_view text) {
+    size_t size = out.size();
+    out.resize(size + text.size());
+    scan::lower(text, out.data() + size);
+}
+
+void formatOperand(const analysis::Operand& operand, bool appendType, std::string& out) {
+    std::string_view text = operand.text;
+    std::string_view type;
+    switch (operand.kind) {
+    case analysis::NO_OPERAND:
+        return;
+    case analysis::REGISTER:
+        type = "Register";
+        break;
+    case analysis::IMMEDIATE:
+        if (text[0] == '$') text.remove_prefix(1);
+        type = "Immediate";
+        break;
+    case analysis::MEMORY:
+        text = text.substr(1, text.size() - 2);
+        type = "Memory Address";
+        break;
+    case analysis::IDENTIFIER:
+        type = "Label/Identifier";
+        break;
+    }
+
+    if (appendType) {
+        appendLower(out, text);
+        out += " (";
+        out += type;
+        out += ')';
+    } else {
+        out += type;
+        out += ": ";
+        appendLower(out, text);
+    }
+}
+
+void formatInstruction(const analysis::Record& record, std::string& out) {
+    switch (record.opcode) {
+    case opcodes::GLOBAL:
+        out += "Declare global symbol ";
+        out += record.operands;
+        return;
+    case opcodes::LEN:
+        out += "Calculate length of ";
+        out += record.operands;
+        return;
+    case opcodes::INT:
+        if (record.argCount == 0) break;
+        out += "Instruction: int | Interrupt: ";
+        out += record.args[0].text;
+        return;
+    case opcodes::PUSH:
+        out += "push instruction: pushed ";
+        out += record.operand;
+        out += " into stack";
+        return;
+    case opcodes::MOV: case opcodes::MOVQ: case opcodes::ADD: case opcodes::ADDQ: case opcodes::SUB: case opcodes::SUBQ:
+        if (record.argCount == 0) break;
+        out += "Instruction: ";
+        out += record.name;
+        out += " | Destination: ";
+        formatOperand(record.args[0], true, out);
+        out += " | Source:";
+        formatOperand(record.args[1], true, out);
+        return;
+    case opcodes::JMP:
+        out += "jmp instruction: jumped to ";
+        out += record.operand;
+        return;
+    case opcodes::CALL:
+        out += "call instruction: called ";
+        out += record.operand;
+        return;
+    case opcodes::RET:
+        out += "ret instruction: returned from function";
+        return;
+    case opcodes::NOP:
+        out += "no operation";
+        return;
+    case opcodes::CMP: case opcodes::MUL: case opcodes::DIV:
+        out += "Instruction: ";
+        out += record.name;
+        out += " | Destination: ";
+        formatOperand(record.args[0], true, out);
+        out += " | Source: ";
+        formatOperand(record.args[1], true, out);
+        return;
+    case opcodes::JE:
+        out += "je instruction: jumped to ";
+        out += record.operand;
+        out += " if equal";
+        return;
+    case opcodes::JNE:
+        out += "jne instruction: jumped to ";
+        out += record.operand;
+        out += " if not equal";
+        return;
+    case opcodes::INC:
+        out += "inc instruction: incremented ";
+        out += record.operand;
+        return;
+    case opcodes::DEC:
+        out += "dec instruction: decremented ";
+        out += record.operand;
+        return;
+    default:
+        break;
+    }
+    out += "Unknown instruction: ";
+    out += record.name;
+}
+
+void formatDirective(const analysis::Record& record, std::string& out) {
+    // Messages of the form <prefix><operand><suffix>, indexed by directives::Id
+    struct Message {
+        std::string_view prefix;
+        std::string_view suffix;
+        bool operand = true;
+    };
+    static constexpr std::array<Message, directives::NONE> MESSAGES = {
+        Message{"string constant ", " declared"},
+        Message{"Data section declared", "", false},
+        Message{"BSS (uninitialized data) section declared", "", false},
+        Message{"Text (code) section declared", "", false},
+        Message{"Global symbol ", " declared"},
+        Message{"Global symbol ", " declared"},
+        Message{"Align to ", " bytes"},
+        Message{"Byte value ", " declared"},
+        Message{"Word value ", " declared"},
+        Message{"Double word value ", " declared"},
+        Message{"Quad word (64-bit) value ", " declared"},
+        Message{"Section ", " declared"},
+        Message{"Constant ", " defined"},
+        Message{"Constant ", " defined"},
+        Message{"Set origin to address ", ""},
+        Message{"Reserve ", " bytes"},
+        Message{"Reserve ", " bytes"},
+        Message{"File name set to ", ""},
+        Message{"Common block ", " declared"},
+        Message{"End of assembly", "", false},
+        Message{"Include binary file ", ""}
+    };
+
+    if (record.directive == directives::NONE) {
+        out += "Unknown directive: ";
+        out += record.name;
+        return;
+    }
+
+    const Message& message = MESSAGES[record.directive];
+    out += message.prefix;
+    if (message.operand) {
+        std::string_view operand = record.operand;
+        if (record.directive == directives::STRING) {
+            // drops the ".string " the operand carries when the line is indented
+            operand = trim(operand);
+            operand.remove_prefix(std::min<size_t>(8, operand.size()));
+        }
+        out += operand;
+    }
+    out += message.suffix;
+}
+
+void formatComment(const analysis::Record& record, std::string& out) {
+    switch (record.kind) {
+    case analysis::BLANK:
+        return;
+    case analysis::LABEL:
+        out += "Label: ";
+        out += record.name;
+        return;
+    case analysis::INSTRUCTION:
+        formatInstruction(record, out);
+        return;
+    case analysis::DIRECTIVE:
+        formatDirective(record, out);
+        return;
+    case analysis::UNKNOWN:
+        out += "Unknown instruction";
+        return;
+    }
+}
+
+void formatRiscOperands(const analysis::Record& record, size_t begin, size_t end, std::string& out) {
+    // The operands are kept as written: `[sp, #16]` and `8(sp)` read best untouched
+    static constexpr std::array<std::string_view, 5> TYPES = {"", "Register", "Immediate", "Memory Address", "Label/Identifier"};
+    for (size_t i = begin; i < end && i < record.argCount; ++i) {
+        if (i != begin) out += ", ";
+        out += record.args[i].text;
+        out += " (";
+        out += TYPES[record.args[i].kind];
+        out += ')';
+    }
+}
+
+void formatRiscBranch(const analysis::Record& record, std::string_view condition, std::string_view zero, std::string_view flags, std::string& out) {
+    out += record.name;
+    out += " instruction: jumped to ";
+    out += record.args[record.argCount - 1].text;
+    if (record.argCount == 3) {
+        out += " if ";
+        out += record.args[0].text;
+        out += condition;
+        out += record.args[1].text;
+    } else if (record.argCount == 2) {
+        out += " if ";
+        out += record.args[0].text;
+        out += zero;
+    } else {
+        out += flags;
+    }
+}
+
+void formatRiscInstruction(const analysis::Record& record, std::string& out) {
+    switch (record.opcode) {
+    case opcodes::MOV: case opcodes::ADD: case opcodes::SUB: case opcodes::MUL: case opcodes::DIV: case opcodes::LOAD:
+        if (record.argCount < 2) break;
+        out += "Instruction: ";
+        out += record.name;
+        out += " | Destination: ";
+        formatRiscOperands(record, 0, 1, out);
+        out += " | Source: ";
+        formatRiscOperands(record, 1, analysis::MAX_ARGS, out);
+        return;
+    case opcodes::STORE:
+        if (record.argCount < 2) break;
+        out += "Instruction: ";
+        out += record.name;
+        out += " | Destination: ";
+        formatRiscOperands(record, 1, analysis::MAX_ARGS, out);
+        out += " | Source: ";
+        formatRiscOperands(record, 0, 1, out);
+        return;
+    case opcodes::CMP:
+        out += "Instruction: ";
+        out += record.name;
+        out += " | Operands: ";
+        formatRiscOperands(record, 0, analysis::MAX_ARGS, out);
+        return;
+    case opcodes::JMP:
+        if (record.argCount == 0) break;
+        out += record.name;
+        out += " instruction: jumped to ";
+        out += record.args[record.argCount - 1].text;
+        return;
+    case opcodes::CALL:
+        if (record.argCount == 0) break;
+        out += record.name;
+        out += " instruction: called ";
+        out += record.args[record.argCount - 1].text;
+        return;
+    case opcodes::JE:
+        if (record.argCount == 0) break;
+        formatRiscBranch(record, " equals ", " is zero", " if equal", out);
+        return;
+    case opcodes::JNE:
+        if (record.argCount == 0) break;
+        formatRiscBranch(record, " does not equal ", " is not zero", " if not equal", out);
+        return;
+    case opcodes::RET:
+        out += record.name;
+        out += " instruction: returned from function";
+        return;
+    case opcodes::PUSH:
+        out += record.name;
+        out += " instruction: pushed ";
+        out += record.operand;
+        out += " into stack";
+        return;
+    case opcodes::POP:
+        out += record.name;
+        out += " instruction: popped ";
+        out += record.operand;
+        out += " from stack";
+        return;
+    case opcodes::INT:
+        out += "Instruction: ";
+        out += record.name;
+        out += " | System call";
+        if (record.argCount != 0) {
+            out += ": ";
+            out += record.args[0].text;
+        }
+        return;
+    case opcodes::NOP:
+        out += "no operation";
+        return;
+    default:
+        break;
+    }
+    out += "Unknown instruction: ";
+    out += record.name;
+}
+
+template <typename Backend>
+void formatComment(const analysis::Record& record, std::string& out) {
+    if constexpr (Backend::RISC) {
+        if (record.kind == analysis::INSTRUCTION) {
+            formatRiscInstruction(record, out);
+            return;
+        }
+        // The operand of a RISC directive never carries the directive itself
+        if (record.kind == analysis::DIRECTIVE && record.directive == directives::STRING) {
+            out += "string constant ";
+            out += record.operand;
+            out += " declared";
+            return;
+        }
+    }
+    formatComment(record, out);
+}
+
+[[nodiscard]] auto analyzeDirective(const std::string& opcode, const std::string& operand) -> std::string {
+    analysis::Record record;
+    record.kind = analysis::DIRECTIVE;
+    record.directive = directives::lookup(opcode);
+    record.name = opcode;
+    record.operand = operand;
+
+    std::string comment;
+    formatDirective(record, comment);
+    return comment;
+}
+
+[[nodiscard]] auto analyzeLine(std::string_view line) -> std::string {
+    std::string comment;
+    formatComment(parseLine(line), comment);
+    return comment;
+}
+
+[[nodiscard]] auto analyzeInstruction(opcodes::Id id, const std::string& opcode, const std::string& operands, std::string_view line) -> std::string {
+    analysis::Record record;
+    record.kind = analysis::INSTRUCTION;
+    record.opcode = id;
+    record.name = opcode;
+    record.operands = operands;
+    record.operand = operandSpan(line);
+    parseInstruction(record, scan::split(record.operands));
+
+    std::string comment;
+    formatInstruction(record, comment);
+    return comment;
+}
+
+[[nodiscard]] auto analyzeOperands(std::string& operands) -> std::string {
+    std::string operandComment;
+    std::string operands2 = operands;
+    size_t pos = 0;
+
+    while ((pos = operands2.find(' ')) != std::string::npos) {
+        std::string operand = operands2.substr(0, pos);
+        operandComment += analyzeOperand(operand) + " ";
+        operands2.erase(0, pos + 1);
+    }
+
+    operandComment += analyzeOperand(operands);
+    return operandComment;
+}
+
+[[nodiscard]] auto analyzeOperand(std::string& operand, bool appendType) -> std::string {
+    scan::lower(operand, operand.data());
+
+    std::string comment;
+    formatOperand(classifyOperand(operand), appendType, comment);
+    return comment;
+}
+
+[[nodiscard]] auto trim(std::string_view str) -> std::string_view {
+    size_t first = str.find_first_not_of(' ');
+    if (std::string_view::npos == first) { return str; }
+
+    size_t last = str.find_last_not_of(' ');
+    return str.substr(first, (last - first + 1));
+}
+
+[[nodiscard]] auto isInstruction(std::string_view opcode) -> bool {
+    return opcodes::lookup(opcode) != opcodes::NONE;
+}
+
+[[nodiscard]] auto getArchitecture(std::string_view source) -> std::string {
+    return std::string(arch::name(arch::detect(source)));
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <directives.hpp>
+#include <registers.hpp>
+#include <opcodes.hpp>
+#include <intern.hpp>
+
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+/**
+ * A namespace for the structured (allocation-free) analysis results.
+ *
+ * parseLine() fills a Record with views into the analyzed line, and
+ * formatComment() renders it into a caller-owned buffer; the text is the
+ * same as what analyzeLine() returns.
+ */
+namespace analysis {
+    /**
+     * Enumerates the line kinds.
+     */
+    enum Kind : uint8_t {
+        /**
+         * Empty or whitespace-only line (no comment).
+         */
+        BLANK,
+        LABEL,
+        INSTRUCTION,
+        DIRECTIVE,
+        /**
+         * Neither a label, a recognized instruction nor a directive.
+         */
+        UNKNOWN
+    };
+
+    /**
+     * Enumerates the operand kinds.
+     */
+    enum OperandKind : uint8_t {
+        NO_OPERAND,
+        REGISTER,
+        IMMEDIATE,
+        MEMORY,
+        IDENTIFIER
+    };
+
+    /**
+     * The most operands a Record splits out; the RISC backends put any further ones
+     * in the last.
+     */
+    inline constexpr size_t MAX_ARGS = 3;
+
+    /**
+     * A classified operand.
+     */
+    struct Operand {
+        std::string_view text; // as written, before lowercasing
+        OperandKind kind = NO_OPERAND;
+        const registers::Register* reg = nullptr; // set for REGISTER operands
+    };
+
+    /**
+     * The classification of an operand's text, which is the same wherever it appears.
+     */
+    struct Classification {
+        OperandKind kind = NO_OPERAND;
+        const registers::Register* reg = nullptr;
+    };
+
+    /**
+     * Classifications of the operands seen so far, by interned text.
+     */
+    using OperandCache = intern::Table<Classification>;
+
+    /**
+     * The analysis of one line. All views point into the analyzed line.
+     */
+    struct Record {
+        Kind kind = BLANK;
+        opcodes::Id opcode = opcodes::NONE;
+        directives::Id directive = directives::NONE;
+        /**
+         * Label name, mnemonic or directive.
+         */
+        std::string_view name;
+        /**
+         * Everything after the mnemonic or directive in the trimmed line.
+         */
+        std::string_view operands;
+        /**
+         * Everything after the first space of the line, without trailing spaces.
+         */
+        std::string_view operand;
+        /**
+         * Destination and source of two-operand forms, or the vector of `int`
+         * (x86); every operand, in order (RISC backends).
+         */
+        std::array<Operand, MAX_ARGS> args {};
+        uint8_t argCount = 0;
+    };
+} // namespace analysis
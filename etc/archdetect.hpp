@@ -0,0 +1,224 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+/**
+ * A namespace for instruction set architecture detection.
+ */
+namespace arch {
+    /**
+     * Enumerates the detectable architectures, in detection priority order
+     * (when one line holds markers of several architectures, the lowest value wins).
+     */
+    enum Isa : uint8_t {
+        X86_64,
+        X86,
+        ARM,
+        MIPS,
+        POWERPC,
+        RISCV,
+        SPARC,
+        /**
+         * No marker seen (yet).
+         */
+        UNKNOWN
+    };
+
+    /**
+     * Display names, indexed by Isa.
+     */
+    inline constexpr std::array<std::string_view, UNKNOWN + 1> NAMES = {
+        "x86-64", "x86", "ARM", "MIPS", "PowerPC", "RISC-V", "SPARC", "Unknown"
+    };
+
+    /**
+     * The length of the longest display name.
+     */
+    inline constexpr size_t NAME_WIDTH = [] {
+        size_t width = 0;
+        for (std::string_view name : NAMES) width = name.size() > width ? name.size() : width;
+        return width;
+    }();
+
+    /**
+     * @return The display name of the given architecture.
+     */
+    [[nodiscard]] constexpr auto name(Isa isa) -> std::string_view {
+        return NAMES[isa];
+    }
+
+    /**
+     * A substring whose presence on a line identifies an architecture.
+     */
+    struct Marker {
+        std::string_view text;
+        Isa isa;
+    };
+
+    inline constexpr std::array MARKERS = {
+        Marker{".code64", X86_64}, Marker{".x64", X86_64}, Marker{".quad", X86_64}, Marker{"BITS 64", X86_64},
+        Marker{"__x86_64__", X86_64}, Marker{"__amd64__", X86_64},
+        Marker{".code32", X86}, Marker{".x86", X86}, Marker{"BITS 32", X86}, Marker{"__i386__", X86},
+        Marker{".arm", ARM}, Marker{".thumb", ARM}, Marker{"__ARM_ARCH", ARM}, Marker{"__arm__", ARM},
+        Marker{"__aarch64__", ARM}, Marker{".arch armv", ARM},
+        Marker{".mips", MIPS}, Marker{".mips64", MIPS}, Marker{"__mips__", MIPS}, Marker{".mdebug.abi", MIPS},
+        Marker{".set noreorder", MIPS},
+        Marker{".ppc", POWERPC}, Marker{"__powerpc__", POWERPC}, Marker{"__ppc__", POWERPC},
+        Marker{".riscv", RISCV}, Marker{"__riscv", RISCV}, Marker{"arch, \"rv", RISCV},
+        Marker{".sparc", SPARC}, Marker{"__sparc__", SPARC}
+    };
+
+    /**
+     * An Aho-Corasick automaton over all MARKERS, built at compile time.
+     *
+     * The input alphabet is compressed to the bytes that occur in a marker plus one
+     * "other" class, and the failure links are folded into a full transition table,
+     * so scanning costs a single table lookup per byte.
+     */
+    class Detector {
+    public:
+        constexpr Detector() {
+            uint8_t classes = 1;
+            for (const Marker& marker : MARKERS) {
+                for (char c : marker.text) {
+                    auto byte = static_cast<uint8_t>(c);
+                    if (classOf_[byte] == 0) classOf_[byte] = classes++;
+                }
+            }
+
+            for (auto& row : next_) row.fill(NONE);
+            out_.fill(UNKNOWN);
+
+            // Trie of the markers
+            size_t states = 1;
+            for (const Marker& marker : MARKERS) {
+                size_t state = 0;
+                for (char c : marker.text) {
+                    uint16_t& target = next_[state][classOf_[static_cast<uint8_t>(c)]];
+                    if (target == NONE) target = static_cast<uint16_t>(states++);
+                    state = target;
+                }
+                if (marker.isa < out_[state]) out_[state] = marker.isa;
+            }
+
+            // Breadth-first failure links, folded into the transition table
+            std::array<uint16_t, MAX_STATES> fail {};
+            std::array<uint16_t, MAX_STATES> queue {};
+            size_t head = 0;
+            size_t tail = 0;
+
+            for (size_t c = 0; c < CLASSES; ++c) {
+                uint16_t& target = next_[0][c];
+                if (target == NONE) {
+                    target = 0;
+                } else {
+                    fail[target] = 0;
+                    queue[tail++] = target;
+                }
+            }
+
+            while (head < tail) {
+                uint16_t state = queue[head++];
+                if (out_[fail[state]] < out_[state]) out_[state] = out_[fail[state]];
+
+                for (size_t c = 0; c < CLASSES; ++c) {
+                    uint16_t& target = next_[state][c];
+                    if (target == NONE) {
+                        target = next_[fail[state]][c];
+                    } else {
+                        fail[target] = next_[fail[state]][c];
+                        queue[tail++] = target;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Scans a single line.
+         *
+         * @param line The line to scan (must not contain '\n').
+         * @return The highest-priority architecture marked on the line, or UNKNOWN.
+         */
+        [[nodiscard]] constexpr auto scanLine(std::string_view line) const -> Isa {
+            uint8_t best = UNKNOWN;
+            uint16_t state = 0;
+            for (char c : line) {
+                state = next_[state][classOf_[static_cast<uint8_t>(c)]];
+                if (out_[state] < best) best = out_[state];
+            }
+            return static_cast<Isa>(best);
+        }
+
+        /**
+         * Scans text up to the end of the first line that carries a marker.
+         *
+         * @param text The text to scan.
+         * @return The architecture of the first marked line, or UNKNOWN.
+         */
+        [[nodiscard]] constexpr auto scan(std::string_view text) const -> Isa {
+            uint8_t best = UNKNOWN;
+            uint16_t state = 0;
+            for (char c : text) {
+                if (c == '\n') {
+                    if (best != UNKNOWN) break;
+                    state = 0;
+                    continue;
+                }
+                state = next_[state][classOf_[static_cast<uint8_t>(c)]];
+                if (out_[state] < best) best = out_[state];
+            }
+            return static_cast<Isa>(best);
+        }
+
+    private:
+        static constexpr size_t MAX_STATES = [] {
+            size_t states = 1;
+            for (const Marker& marker : MARKERS) states += marker.text.size();
+            return states;
+        }();
+        static constexpr size_t CLASSES = [] {
+            std::array<bool, 256> seen {};
+            size_t classes = 1;
+            for (const Marker& marker : MARKERS) {
+                for (char c : marker.text) {
+                    if (!seen[static_cast<uint8_t>(c)]) ++classes;
+                    seen[static_cast<uint8_t>(c)] = true;
+                }
+            }
+            return classes;
+        }();
+        static constexpr uint16_t NONE = 0xFFFF;
+
+        std::array<uint8_t, 256> classOf_ {}; // class 0 is "any other byte"
+        std::array<std::array<uint16_t, CLASSES>, MAX_STATES> next_ {};
+        std::array<uint8_t, MAX_STATES> out_ {};
+    };
+
+    inline constexpr Detector DETECTOR {};
+
+    /**
+     * How far into an input detect() looks for a marker (1 MiB).
+     */
+    inline constexpr size_t PREFIX = static_cast<size_t>(1) << 20;
+
+    /**
+     * Detects the architecture of an input from its first PREFIX bytes only, so that
+     * every mode agrees on the same bytes: whole files, and streams (stdin, compressed
+     * files, daemon buffers) once their first PREFIX bytes have arrived. A marker that
+     * first appears past PREFIX is ignored, and such inputs are analyzed as UNKNOWN.
+     *
+     * @param text The input, or at least its first PREFIX bytes.
+     * @return The architecture of the first marked line within the prefix, or UNKNOWN.
+     */
+    [[nodiscard]] constexpr auto detect(std::string_view text) -> Isa {
+        return DETECTOR.scan(text.substr(0, PREFIX < text.size() ? PREFIX : text.size()));
+    }
+
+    static_assert(DETECTOR.scan("foo\n  .quad 1\n") == X86_64);
+    static_assert(DETECTOR.scan("mov .arm BITS 32\n.quad") == X86);
+    static_assert(DETECTOR.scan("\t__riscv_xlen\n") == RISCV);
+    static_assert(DETECTOR.scan("nothing here\n") == UNKNOWN);
+    static_assert(DETECTOR.scan("\t.arch armv8-a\n") == ARM && DETECTOR.scan("\t.attribute arch, \"rv64i2p1\"\n") == RISCV);
+} // namespace arch
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <hash.hpp>
+
+#include <system_error>
+#include <string_view>
+#include <filesystem>
+#include <cstdint>
+#include <random>
+#include <atomic>
+#include <string>
+#if defined(__linux__) && __has_include(<linux/fs.h>)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A namespace for the persistent analysis cache.
+ */
+namespace cache {
+    namespace fs = std::filesystem;
+
+    /**
+     * @return A unique sibling of `path` to write to before renaming it into place.
+     */
+    [[nodiscard]] inline auto temporaryName(const fs::path& path) -> fs::path {
+        thread_local std::mt19937_64 random(std::random_device{}());
+        fs::path temporary = path;
+        temporary += ".tmp-" + hash::hex(random());
+        return temporary;
+    }
+
+    /**
+     * Creates `to` as an independent copy of `from`, sharing the data blocks copy-on-write
+     * (a reflink) where the filesystem supports it and copying them otherwise. Unlike a
+     * hard link, writing to either file in place never changes the other.
+     *
+     * @return Whether the copy was made.
+     */
+    inline auto clone(const fs::path& from, const fs::path& to, std::error_code& ec) -> bool {
+#if defined(__linux__) && defined(FICLONE)
+        int source = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (source >= 0) {
+            int target = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+            bool cloned = target >= 0 && ::ioctl(target, FICLONE, source) == 0;
+            if (target >= 0) ::close(target);
+            ::close(source);
+            if (cloned) return true;
+        }
+#endif
+        return fs::copy_file(from, to, fs::copy_options::overwrite_existing, ec);
+    }
+
+    /**
+     * A directory of analyzed outputs keyed by a hash and the size of the input contents
+     * (and by the source path, for outputs that embed it) and the analyzer version.
+     *
+     * Entries are immutable once published. They are created under a unique temporary
+     * name and renamed into place, so concurrent runs sharing the directory only ever
+     * see complete entries. Outputs never share an inode with their entries: both
+     * directions clone (see clone()), so editing an output in place cannot corrupt
+     * the entry other inputs are restored from.
+     */
+    class Store {
+    public:
+        /**
+         * Opens (and creates, if needed) the cache directory.
+         *
+         * @param directory The cache directory.
+         * @param version The analyzer version, mixed into every key.
+         */
+        Store(fs::path directory, std::string_view version)
+            : directory_(std::move(directory)), seed_(hash::xxh64(version)) {
+            std::error_code ec;
+            fs::create_directories(directory_, ec);
+            good_ = fs::is_directory(directory_, ec);
+        }
+
+        /**
+         * @return Whether the cache directory is usable.
+         */
+        [[nodiscard]] explicit operator bool() const { return good_; }
+
+        /**
+         * @param contents The input contents.
+         * @param source The source path, when the output embeds it (empty otherwise).
+         * @return The key of the given input. Its size is part of it, so a hit needs both
+         *         the hash and the size to match.
+         */
+        [[nodiscard]] auto key(std::string_view contents, std::string_view source = {}) const -> std::string {
+            std::string key = hash::hex(hash::xxh64(contents, seed_)) + "-" + std::to_string(contents.size());
+            if (!source.empty()) key += "-" + hash::hex(hash::xxh64(source, seed_));
+            return key;
+        }
+
+        /**
+         * Puts a copy of the cached output for `key` at `output`.
+         *
+         * @param key The input key.
+         * @param output Where the analyzed output belongs.
+         * @return False on a cache miss (or if the entry could not be used).
+         */
+        [[nodiscard]] auto restore(const std::string& key, const fs::path& output) -> bool {
+            fs::path entry = directory_ / key;
+            std::error_code ec;
+            if (!fs::is_regular_file(entry, ec)) return false;
+
+            // Clone next to the output, then atomically replace it
+            fs::path temporary = temporaryName(output);
+            clone(entry, temporary, ec);
+            if (!ec) fs::rename(temporary, output, ec);
+            if (ec) {
+                fs::remove(temporary, ec);
+                return false;
+            }
+
+            ++hits_;
+            return true;
+        }
+
+        /**
+         * Publishes a freshly written output under `key`.
+         *
+         * @param key The input key.
+         * @param output The complete analyzed output.
+         * @return Whether the entry was stored.
+         */
+        auto publish(const std::string& key, const fs::path& output) -> bool {
+            fs::path temporary = temporaryName(directory_ / key);
+            std::error_code ec;
+            clone(output, temporary, ec);
+            if (!ec) fs::rename(temporary, directory_ / key, ec);
+            if (ec) {
+                fs::remove(temporary, ec);
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @return The number of outputs served from the cache so far.
+         */
+        [[nodiscard]] auto hits() const -> size_t { return hits_; }
+
+    private:
+        fs::path directory_;
+        uint64_t seed_;
+        bool good_ = false;
+        std::atomic<size_t> hits_ = 0;
+    };
+} // namespace cache
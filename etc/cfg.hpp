@@ -0,0 +1,270 @@
+#pragma once
+
+#include <xref.hpp>
+#include <intern.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <array>
+
+/**
+ * A namespace for basic blocks and the control-flow graph between them.
+ */
+namespace cfg {
+    /**
+     * Enumerates the export formats.
+     */
+    enum Format : uint8_t {
+        NONE,
+        DOT,
+        /**
+         * The CSR arrays as little-endian binary (see Builder::writeBinary()).
+         */
+        BINARY
+    };
+
+    /**
+     * The extension of the file each format is written to, next to the analyzed output.
+     */
+    inline constexpr std::array<std::string_view, BINARY + 1> EXTENSIONS = {"", ".dot", ".cfg"};
+
+    /**
+     * Enumerates the edge kinds.
+     */
+    enum Edge : uint8_t {
+        FALLTHROUGH,
+        JUMP,
+        /**
+         * The taken side of je/jne.
+         */
+        BRANCH,
+        CALL
+    };
+
+    inline constexpr std::array<std::string_view, CALL + 1> EDGE_NAMES = {"fallthrough", "jump", "branch", "call"};
+
+    /**
+     * A basic block: a range of source lines entered only at the top.
+     */
+    struct Block {
+        uint64_t first = 0; // 1-based source lines, inclusive
+        uint64_t last = 0;
+        intern::Id label = intern::NONE;
+    };
+
+    /**
+     * The graph in compressed sparse row form: the edges leaving block `b` are
+     * `targets[offsets[b]]` to `targets[offsets[b + 1] - 1]`, with matching `kinds`.
+     */
+    struct Graph {
+        std::vector<Block> blocks;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<Edge> kinds;
+        /**
+         * Edges to symbols that are not defined in the file (left out of the arrays).
+         */
+        uint64_t external = 0;
+    };
+
+    /**
+     * Collects the labels and branches of a file during the analysis pass, and builds
+     * the graph from them afterwards. Only those lines are kept, never the
+     * instructions in between, so the cost is proportional to the branches.
+     */
+    class Builder {
+    public:
+        Builder() = default;
+        Builder(const Builder&) = delete;
+        auto operator=(const Builder&) -> Builder& = delete;
+
+        /**
+         * Adds the uses found in a chunk (see xref::collect()).
+         *
+         * @param events The chunk's uses, in line order.
+         * @param firstLine The 1-based line number of the chunk's first line.
+         * @param lines The number of lines in the chunk.
+         */
+        void add(const std::vector<xref::Event>& events, uint64_t firstLine, uint64_t lines) {
+            for (const xref::Event& event : events) {
+                if (event.use == xref::GLOBAL) continue;
+                intern::Id name = event.name.empty() ? intern::NONE : names_.intern(event.name).first;
+                events_.push_back({firstLine + event.line, name, event.use});
+            }
+            lines_ = firstLine + lines - 1;
+        }
+
+        /**
+         * Splits the file into blocks at labels and after branches, and connects them.
+         */
+        [[nodiscard]] auto build() const -> Graph {
+            Graph graph;
+            std::vector<xref::Use> ends; // the branch that closes each block (DEFINITION: none)
+            std::vector<intern::Id> targets;
+            std::vector<uint32_t> blockOf(names_.size(), UINT32_MAX);
+
+            auto open = [&](uint64_t line) {
+                graph.blocks.push_back({line, line, intern::NONE});
+                ends.push_back(xref::DEFINITION);
+                targets.push_back(intern::NONE);
+            };
+            open(1);
+
+            for (const Event& event : events_) {
+                Block* block = &graph.blocks.back();
+                if (event.use == xref::DEFINITION) {
+                    // A label starts a block, unless the current one starts on this very line
+                    if (block->first < event.line) {
+                        block->last = event.line - 1;
+                        open(event.line);
+                        block = &graph.blocks.back();
+                    }
+                    block->label = event.name;
+                    if (blockOf[event.name] == UINT32_MAX) blockOf[event.name] = static_cast<uint32_t>(graph.blocks.size() - 1);
+                    continue;
+                }
+
+                block->last = event.line;
+                ends.back() = event.use;
+                targets.back() = event.name;
+                open(event.line + 1);
+            }
+            graph.blocks.back().last = std::max(graph.blocks.back().first, lines_);
+            if (graph.blocks.size() > 1 && graph.blocks.back().first > lines_ && graph.blocks.back().label == intern::NONE) {
+                graph.blocks.pop_back();
+                ends.pop_back();
+                targets.pop_back();
+            }
+
+            graph.offsets.reserve(graph.blocks.size() + 1);
+            for (size_t b = 0; b < graph.blocks.size(); ++b) {
+                graph.offsets.push_back(static_cast<uint32_t>(graph.targets.size()));
+                bool last = b + 1 == graph.blocks.size();
+                auto edge = [&](uint32_t target, Edge kind) {
+                    graph.targets.push_back(target);
+                    graph.kinds.push_back(kind);
+                };
+                auto to = [&](Edge kind) {
+                    uint32_t target = targets[b] == intern::NONE ? UINT32_MAX : blockOf[targets[b]];
+                    if (target == UINT32_MAX) ++graph.external;
+                    else edge(target, kind);
+                };
+
+                switch (ends[b]) {
+                case xref::JMP:
+                    to(JUMP);
+                    break;
+                case xref::JE: case xref::JNE:
+                    to(BRANCH);
+                    if (!last) edge(static_cast<uint32_t>(b + 1), FALLTHROUGH);
+                    break;
+                case xref::CALL:
+                    to(CALL);
+                    if (!last) edge(static_cast<uint32_t>(b + 1), FALLTHROUGH);
+                    break;
+                case xref::RET:
+                    break;
+                default:
+                    if (!last) edge(static_cast<uint32_t>(b + 1), FALLTHROUGH);
+                    break;
+                }
+            }
+            graph.offsets.push_back(static_cast<uint32_t>(graph.targets.size()));
+            return graph;
+        }
+
+        /**
+         * @return The label of a block ("" for unlabeled blocks).
+         */
+        [[nodiscard]] auto label(const Block& block) const -> std::string_view {
+            return block.label == intern::NONE ? std::string_view() : names_.text(block.label);
+        }
+
+        /**
+         * Renders the graph in Graphviz DOT.
+         */
+        void writeDot(const Graph& graph, std::string& out) const {
+            out += "digraph cfg {\n\tnode [shape=box, fontname=monospace];\n";
+            for (size_t b = 0; b < graph.blocks.size(); ++b) {
+                const Block& block = graph.blocks[b];
+                out += "\tb" + std::to_string(b) + " [label=\"";
+                for (char c : label(block)) {
+                    if (c == '"' || c == '\\') out += '\\';
+                    out += c;
+                }
+                if (block.label != intern::NONE) out += "\\n";
+                out += "lines " + std::to_string(block.first) + '-' + std::to_string(block.last) + "\"];\n";
+            }
+            for (size_t b = 0; b < graph.blocks.size(); ++b) {
+                for (uint32_t e = graph.offsets[b]; e < graph.offsets[b + 1]; ++e) {
+                    out += "\tb" + std::to_string(b) + " -> b" + std::to_string(graph.targets[e]);
+                    if (graph.kinds[e] != FALLTHROUGH) {
+                        out += " [label=\"";
+                        out += EDGE_NAMES[graph.kinds[e]];
+                        out += graph.kinds[e] == CALL ? "\", style=dashed]" : "\"]";
+                    }
+                    out += ";\n";
+                }
+            }
+            out += "}\n";
+        }
+
+        /**
+         * Renders the graph as binary: "ASMCFG1\0", then u32 block count, u32 edge count,
+         * u64 external edge count, the blocks (u64 first line, u64 last line, u32 label
+         * offset into the names, u32 label size), the u32 offsets, the u32 targets, the
+         * u8 kinds and the label names.
+         */
+        void writeBinary(const Graph& graph, std::string& out) const {
+            auto put = [&out](auto value) {
+                char bytes[sizeof(value)];
+                std::memcpy(bytes, &value, sizeof(value));
+                out.append(bytes, sizeof(value));
+            };
+
+            out.append("ASMCFG1\0", 8);
+            put(static_cast<uint32_t>(graph.blocks.size()));
+            put(static_cast<uint32_t>(graph.targets.size()));
+            put(graph.external);
+
+            std::string names;
+            for (const Block& block : graph.blocks) {
+                std::string_view name = label(block);
+                put(block.first);
+                put(block.last);
+                put(static_cast<uint32_t>(names.size()));
+                put(static_cast<uint32_t>(name.size()));
+                names += name;
+            }
+            for (uint32_t offset : graph.offsets) put(offset);
+            for (uint32_t target : graph.targets) put(target);
+            for (Edge kind : graph.kinds) put(static_cast<uint8_t>(kind));
+            out += names;
+        }
+
+        /**
+         * Builds the graph and renders it in `format`.
+         */
+        void write(Format format, std::string& out) const {
+            Graph graph = build();
+            if (format == DOT) writeDot(graph, out);
+            else if (format == BINARY) writeBinary(graph, out);
+        }
+
+    private:
+        struct Event {
+            uint64_t line = 0;
+            intern::Id name = intern::NONE;
+            xref::Use use = xref::DEFINITION;
+        };
+
+        intern::Arena arena_;
+        intern::Table<bool> names_ {arena_};
+        std::vector<Event> events_;
+        uint64_t lines_ = 0;
+    };
+} // namespace cfg
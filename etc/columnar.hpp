@@ -0,0 +1,385 @@
+#pragma once
+
+#include <archdetect.hpp>
+#include <tokenizer.hpp>
+#include <analysis.hpp>
+#include <hash.hpp>
+#include <isa.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <array>
+
+/**
+ * A namespace for the columnar output format, an alternative to the annotated text
+ * for tools that query the analysis instead of reading it.
+ *
+ * A file is a fixed header followed by one array per field, each holding a value per
+ * source line (or three, for the operands) and starting on an 8-byte boundary. All
+ * integers are little-endian. Text is never copied: names and operands are spans
+ * into the lines of the original file, whose size and hash the header records.
+ *
+ *     offset  size  field
+ *          0     8  magic "ASMCOL1\0"
+ *          8     4  version
+ *         12     1  architecture (arch::Isa)
+ *         13     1  flags (COMPACT)
+ *         14     2  reserved
+ *         16     8  line count N
+ *         24     8  source size
+ *         32     8  source hash (xxh64)
+ *         40     4  source path size
+ *         44     4  reserved
+ *         48        u64[N] line offsets, u32[N] line sizes, u8[N] kinds, u8[N] opcode or
+ *                   directive IDs, u8[N] operand counts, u8[3N] operand kinds,
+ *                   Span[3N] name/operands/operand, Span[3N] operands, the source path
+ *
+ * Spans are a u32 offset and a u32 size. In COMPACT files (sources under 4 GiB without
+ * a line of 64 KiB or more, so nearly all of them) the line offsets are u32, and the
+ * line sizes and both halves of a span are u16.
+ */
+namespace columnar {
+    inline constexpr std::string_view MAGIC {"ASMCOL1\0", 8};
+
+    /**
+     * Bumped whenever the layout changes; readers reject other versions.
+     */
+    inline constexpr uint32_t VERSION = 2;
+
+    inline constexpr uint64_t HEADER_SIZE = 48;
+
+    /**
+     * Header flags.
+     */
+    enum Flag : uint8_t {
+        COMPACT = 1
+    };
+
+    /**
+     * A range of a line, relative to the line's first byte.
+     */
+    struct Span {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    /**
+     * Indexes into the per-line Span column.
+     */
+    enum Field : uint8_t {
+        NAME,
+        OPERANDS,
+        OPERAND,
+        FIELD_COUNT
+    };
+
+    /**
+     * Where each column starts, for a file of `lines` lines.
+     */
+    struct Layout {
+        uint64_t begins, sizes, kinds, ids, argCounts, argKinds, spans, args, path, end;
+        uint64_t offsetWidth, sizeWidth; // bytes per line offset, per line size and per span half
+
+        Layout(uint64_t lines, uint64_t pathSize, bool compact)
+            : offsetWidth(compact ? 4 : 8), sizeWidth(compact ? 2 : 4) {
+            uint64_t at = HEADER_SIZE;
+            auto column = [&at, lines](uint64_t width) {
+                uint64_t start = at;
+                at = (at + lines * width + 7) & ~static_cast<uint64_t>(7);
+                return start;
+            };
+            begins = column(offsetWidth);
+            sizes = column(sizeWidth);
+            kinds = column(1);
+            ids = column(1);
+            argCounts = column(1);
+            argKinds = column(analysis::MAX_ARGS);
+            spans = column(sizeWidth * 2 * FIELD_COUNT);
+            args = column(sizeWidth * 2 * analysis::MAX_ARGS);
+            path = at;
+            end = path + pathSize;
+        }
+    };
+
+    /**
+     * The columns of consecutive lines, filled by one worker and merged by the Writer.
+     */
+    struct Columns {
+        uint64_t base = 0; // offset of the first line's chunk in the source
+        std::vector<uint64_t> begins; // relative to `base`
+        std::vector<uint32_t> sizes;
+        std::vector<uint8_t> kinds;
+        std::vector<uint8_t> ids;
+        std::vector<uint8_t> argCounts;
+        std::vector<uint8_t> argKinds;
+        std::vector<Span> spans;
+        std::vector<Span> args;
+        uint64_t longest = 0; // the size of the longest line
+
+        /**
+         * Adds a line.
+         *
+         * @param record The line's analysis; its views point into `line`.
+         * @param line The line.
+         * @param begin The line's offset from `base`.
+         */
+        void add(const analysis::Record& record, std::string_view line, uint64_t begin) {
+            auto span = [line](std::string_view text) -> Span {
+                if (text.empty()) return {};
+                return {static_cast<uint32_t>(text.data() - line.data()), static_cast<uint32_t>(text.size())};
+            };
+
+            begins.push_back(begin);
+            sizes.push_back(static_cast<uint32_t>(line.size()));
+            longest = std::max<uint64_t>(longest, line.size());
+            kinds.push_back(record.kind);
+            ids.push_back(record.kind == analysis::DIRECTIVE ? static_cast<uint8_t>(record.directive) : static_cast<uint8_t>(record.opcode));
+            argCounts.push_back(record.argCount);
+            spans.push_back(span(record.name));
+            spans.push_back(span(record.operands));
+            spans.push_back(span(record.operand));
+            for (const analysis::Operand& arg : record.args) {
+                argKinds.push_back(arg.kind);
+                args.push_back(span(arg.text));
+            }
+        }
+
+        [[nodiscard]] auto size() const -> size_t { return kinds.size(); }
+    };
+
+    /**
+     * Collects the columns of a file in line order and writes them out.
+     */
+    class Writer {
+    public:
+        Writer() = default;
+        Writer(const Writer&) = delete;
+        auto operator=(const Writer&) -> Writer& = delete;
+
+        void add(Columns&& columns) {
+            lines_ += columns.size();
+            longest_ = std::max(longest_, columns.longest);
+            chunks_.push_back(std::move(columns));
+        }
+
+        /**
+         * Writes the file, one column at a time.
+         *
+         * @param sink Anything with `write(std::string&&)`, such as io::OutputFile.
+         * @param architecture The detected architecture.
+         * @param source The analyzed source.
+         * @param path The source path recorded for converters.
+         */
+        template <typename Sink>
+        void write(Sink& sink, arch::Isa architecture, std::string_view source, std::string_view path) const {
+            bool compact = source.size() <= UINT32_MAX && longest_ <= UINT16_MAX;
+            std::string block;
+            auto put = [&block](auto value) {
+                char bytes[sizeof(value)];
+                std::memcpy(bytes, &value, sizeof(value));
+                block.append(bytes, sizeof(value));
+            };
+            auto finish = [&block, &sink] {
+                block.resize((block.size() + 7) & ~static_cast<size_t>(7), '\0');
+                sink.write(std::move(block));
+                block = std::string();
+            };
+            auto size = [&put, compact](uint32_t value) {
+                if (compact) put(static_cast<uint16_t>(value));
+                else put(value);
+            };
+            auto spans = [&](std::vector<Span> Columns::*field) {
+                for (const Columns& chunk : chunks_) {
+                    for (const Span& span : chunk.*field) {
+                        size(span.offset);
+                        size(span.size);
+                    }
+                }
+                finish();
+            };
+            auto bytes = [&](std::vector<uint8_t> Columns::*field) {
+                for (const Columns& chunk : chunks_) block.append(reinterpret_cast<const char*>((chunk.*field).data()), (chunk.*field).size());
+                finish();
+            };
+
+            block.append(MAGIC);
+            put(VERSION);
+            put(static_cast<uint8_t>(architecture));
+            put(static_cast<uint8_t>(compact ? COMPACT : 0));
+            block.append(2, '\0');
+            put(static_cast<uint64_t>(lines_));
+            put(static_cast<uint64_t>(source.size()));
+            put(hash::xxh64(source));
+            put(static_cast<uint32_t>(path.size()));
+            put(static_cast<uint32_t>(0));
+            finish();
+
+            for (const Columns& chunk : chunks_) {
+                for (uint64_t begin : chunk.begins) {
+                    if (compact) put(static_cast<uint32_t>(chunk.base + begin));
+                    else put(chunk.base + begin);
+                }
+            }
+            finish();
+            for (const Columns& chunk : chunks_) {
+                for (uint32_t value : chunk.sizes) size(value);
+            }
+            finish();
+            bytes(&Columns::kinds);
+            bytes(&Columns::ids);
+            bytes(&Columns::argCounts);
+            bytes(&Columns::argKinds);
+            spans(&Columns::spans);
+            spans(&Columns::args);
+            block.append(path);
+            sink.write(std::move(block));
+        }
+
+    private:
+        std::vector<Columns> chunks_;
+        uint64_t lines_ = 0;
+        uint64_t longest_ = 0;
+    };
+
+    /**
+     * Reads a columnar file in place (typically a mapping of it, see io::InputFile).
+     *
+     * The accessors do no bounds checking; the constructor checks that the columns
+     * fit in the data.
+     */
+    class Reader {
+    public:
+        explicit Reader(std::string_view data) : data_(data), layout_(0, 0, false) {
+            if (data.size() < HEADER_SIZE || data.substr(0, MAGIC.size()) != MAGIC) {
+                error_ = "not a columnar analysis file";
+                return;
+            }
+            if (load<uint32_t>(8) != VERSION) {
+                error_ = "unsupported columnar version " + std::to_string(load<uint32_t>(8));
+                return;
+            }
+            lines_ = load<uint64_t>(16);
+            uint64_t pathSize = load<uint32_t>(40);
+            // Every line takes more than one byte, so larger counts cannot fit either
+            if (lines_ <= data.size()) layout_ = Layout(lines_, pathSize, (byte(13) & COMPACT) != 0);
+            if (lines_ > data.size() || layout_.end > data.size()) error_ = "truncated columnar file";
+        }
+
+        /**
+         * @return Whether the data is a columnar file this reader understands.
+         */
+        [[nodiscard]] explicit operator bool() const { return error_.empty(); }
+
+        /**
+         * @return Why the data was rejected.
+         */
+        [[nodiscard]] auto error() const -> const std::string& { return error_; }
+
+        [[nodiscard]] auto lines() const -> uint64_t { return lines_; }
+        [[nodiscard]] auto architecture() const -> arch::Isa { return static_cast<arch::Isa>(static_cast<uint8_t>(data_[12])); }
+        [[nodiscard]] auto sourceSize() const -> uint64_t { return load<uint64_t>(24); }
+        [[nodiscard]] auto sourceHash() const -> uint64_t { return load<uint64_t>(32); }
+        [[nodiscard]] auto sourcePath() const -> std::string_view {
+            return data_.substr(layout_.path, layout_.end - layout_.path);
+        }
+
+        /**
+         * @return Whether `source` is the file the analysis was made from.
+         */
+        [[nodiscard]] auto matches(std::string_view source) const -> bool {
+            return source.size() == sourceSize() && hash::xxh64(source) == sourceHash();
+        }
+
+        [[nodiscard]] auto begin(uint64_t line) const -> uint64_t {
+            uint64_t at = layout_.begins + line * layout_.offsetWidth;
+            return layout_.offsetWidth == 4 ? load<uint32_t>(at) : load<uint64_t>(at);
+        }
+
+        [[nodiscard]] auto size(uint64_t line) const -> uint32_t { return half(layout_.sizes + line * layout_.sizeWidth); }
+        [[nodiscard]] auto kind(uint64_t line) const -> analysis::Kind { return static_cast<analysis::Kind>(byte(layout_.kinds + line)); }
+        [[nodiscard]] auto argCount(uint64_t line) const -> uint8_t { return byte(layout_.argCounts + line); }
+
+        [[nodiscard]] auto opcode(uint64_t line) const -> opcodes::Id {
+            return kind(line) == analysis::DIRECTIVE ? opcodes::NONE : static_cast<opcodes::Id>(byte(layout_.ids + line));
+        }
+
+        [[nodiscard]] auto directive(uint64_t line) const -> directives::Id {
+            return kind(line) == analysis::DIRECTIVE ? static_cast<directives::Id>(byte(layout_.ids + line)) : directives::NONE;
+        }
+
+        [[nodiscard]] auto argKind(uint64_t line, size_t arg) const -> analysis::OperandKind {
+            return static_cast<analysis::OperandKind>(byte(layout_.argKinds + line * analysis::MAX_ARGS + arg));
+        }
+
+        [[nodiscard]] auto span(uint64_t line, Field field) const -> Span {
+            uint64_t at = layout_.spans + (line * FIELD_COUNT + field) * layout_.sizeWidth * 2;
+            return {half(at), half(at + layout_.sizeWidth)};
+        }
+
+        [[nodiscard]] auto argSpan(uint64_t line, size_t arg) const -> Span {
+            uint64_t at = layout_.args + (line * analysis::MAX_ARGS + arg) * layout_.sizeWidth * 2;
+            return {half(at), half(at + layout_.sizeWidth)};
+        }
+
+        /**
+         * @return The text of a line in `source`.
+         */
+        [[nodiscard]] auto line(uint64_t line, std::string_view source) const -> std::string_view {
+            return source.substr(begin(line), size(line));
+        }
+
+        /**
+         * Rebuilds the analysis of a line, with views into `source`.
+         */
+        [[nodiscard]] auto record(uint64_t line, std::string_view source) const -> analysis::Record {
+            std::string_view text = this->line(line, source);
+            auto view = [text](Span span) { return text.substr(span.offset, span.size); };
+
+            analysis::Record record;
+            record.kind = kind(line);
+            record.opcode = opcode(line);
+            record.directive = directive(line);
+            record.name = view(span(line, NAME));
+            record.operands = view(span(line, OPERANDS));
+            record.operand = view(span(line, OPERAND));
+            record.argCount = argCount(line);
+            for (size_t arg = 0; arg < record.args.size(); ++arg) {
+                analysis::Operand& operand = record.args[arg];
+                operand.text = view(argSpan(line, arg));
+                operand.kind = argKind(line, arg);
+                if (operand.kind == analysis::REGISTER && operand.text.size() <= isa::REGISTER_WIDTH) {
+                    std::array<char, isa::REGISTER_WIDTH> lower {};
+                    scan::lower(operand.text, lower.data());
+                    operand.reg = isa::lookupRegister(architecture(), std::string_view(lower.data(), operand.text.size()));
+                }
+            }
+            return record;
+        }
+
+    private:
+        template <typename T>
+        [[nodiscard]] auto load(uint64_t offset) const -> T {
+            T value;
+            std::memcpy(&value, data_.data() + offset, sizeof(T));
+            return value;
+        }
+
+        [[nodiscard]] auto byte(uint64_t offset) const -> uint8_t { return static_cast<uint8_t>(data_[offset]); }
+
+        /**
+         * @return A line size or span half, whose width depends on COMPACT.
+         */
+        [[nodiscard]] auto half(uint64_t offset) const -> uint32_t {
+            return layout_.sizeWidth == 2 ? load<uint16_t>(offset) : load<uint32_t>(offset);
+        }
+
+        std::string_view data_;
+        Layout layout_;
+        uint64_t lines_ = 0;
+        std::string error_;
+    };
+} // namespace columnar
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <input.hpp>
+#include <stats.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <stdexcept>
+#include <climits>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <array>
+#if defined(ASM_ANALYZE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(ASM_ANALYZE_ZSTD)
+#include <zstd.h>
+#endif
+
+/**
+ * A namespace for compressed inputs and outputs.
+ *
+ * A `.gz` or `.zst` input is decompressed while it is read, through the io::Reader of
+ * its codec. It then takes the same bounded-memory path as stdin and never touches
+ * the disk uncompressed.
+ *
+ * A compressed output is a sequence of independent frames (gzip members, zstd frames),
+ * one per analyzed chunk. Each frame is compressed by the worker that analyzed its
+ * chunk, so compression runs on every thread of the pool. The concatenation is one
+ * valid file for `gzip -d` and `zstd -d`.
+ *
+ * A codec is only available when its library was found at build time
+ * (ASM_ANALYZE_ZLIB, ASM_ANALYZE_ZSTD).
+ */
+namespace compression {
+    enum Codec : uint8_t {
+        NONE,
+        GZIP,
+        ZSTD
+    };
+
+    inline constexpr std::array<std::string_view, ZSTD + 1> EXTENSIONS = {"", ".gz", ".zst"};
+
+    inline constexpr std::array<std::string_view, ZSTD + 1> NAMES = {"none", "gz", "zst"};
+
+    /**
+     * The codec of the outputs that are not named by --output (set by --compress).
+     */
+    inline Codec output = NONE;
+
+    /**
+     * @return Whether `codec` was compiled in.
+     */
+    [[nodiscard]] constexpr auto available(Codec codec) -> bool {
+        switch (codec) {
+        case GZIP:
+#if defined(ASM_ANALYZE_ZLIB)
+            return true;
+#else
+            return false;
+#endif
+        case ZSTD:
+#if defined(ASM_ANALYZE_ZSTD)
+            return true;
+#else
+            return false;
+#endif
+        default: return true;
+        }
+    }
+
+    /**
+     * @return The codec named by the extension of `path` (in any case), or NONE.
+     */
+    [[nodiscard]] inline auto codecOf(std::string_view path) -> Codec {
+        for (Codec codec : {GZIP, ZSTD}) {
+            std::string_view extension = EXTENSIONS[codec];
+            if (path.size() > extension.size()
+                && std::equal(extension.begin(), extension.end(), path.end() - static_cast<std::ptrdiff_t>(extension.size()),
+                              [](char a, char b) { return a == static_cast<char>(std::tolower(static_cast<unsigned char>(b))); }))
+                return codec;
+        }
+        return NONE;
+    }
+
+    /**
+     * @return `path` without the extension of its codec.
+     */
+    [[nodiscard]] inline auto strip(std::string_view path) -> std::string_view {
+        return path.substr(0, path.size() - EXTENSIONS[codecOf(path)].size());
+    }
+
+    /**
+     * Reads a --compress name.
+     *
+     * @return False if `name` is not a codec.
+     */
+    [[nodiscard]] inline auto parse(std::string_view name, Codec& codec) -> bool {
+        auto it = std::find(NAMES.begin(), NAMES.end(), name);
+        if (it == NAMES.end()) return false;
+        codec = static_cast<Codec>(it - NAMES.begin());
+        return true;
+    }
+
+    namespace detail {
+        [[noreturn]] inline void unavailable(Codec codec) {
+            throw std::runtime_error("asm-analyze was built without " + std::string(NAMES[codec]) + " support");
+        }
+
+#if defined(ASM_ANALYZE_ZLIB)
+        /**
+         * The largest input of one gzip member, which keeps every size within zlib's 32 bits.
+         */
+        inline constexpr size_t MEMBER_SIZE = static_cast<size_t>(1) << 30;
+
+        inline void deflateMember(std::string_view text, std::string& out) {
+            z_stream stream {};
+            if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                throw std::runtime_error("Cannot initialize zlib");
+            size_t offset = out.size();
+            out.resize(offset + deflateBound(&stream, static_cast<uLong>(text.size())));
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+            stream.avail_in = static_cast<uInt>(text.size());
+            stream.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+            stream.avail_out = static_cast<uInt>(out.size() - offset);
+            int status = deflate(&stream, Z_FINISH);
+            out.resize(out.size() - stream.avail_out);
+            deflateEnd(&stream);
+            if (status != Z_STREAM_END) throw std::runtime_error("gzip compression failed");
+        }
+#endif
+    } // namespace detail
+
+#if defined(ASM_ANALYZE_ZLIB)
+    /**
+     * Inflates gzip (or zlib) data, concatenated members included.
+     */
+    class GzipReader final : public io::Reader {
+    public:
+        /**
+         * @param data The compressed bytes; they must outlive the reader.
+         */
+        explicit GzipReader(std::string_view data) : data_(data) {
+            if (inflateInit2(&stream_, MAX_WBITS + 32) != Z_OK) throw std::runtime_error("Cannot initialize zlib");
+        }
+
+        ~GzipReader() override { inflateEnd(&stream_); }
+
+        [[nodiscard]] auto read(char* data, size_t size) -> size_t override {
+            size_t filled = 0;
+            while (filled < size && !done_) {
+                if (stream_.avail_in == 0) {
+                    auto take = static_cast<uInt>(std::min<size_t>(data_.size() - consumed_, UINT_MAX));
+                    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data_.data() + consumed_));
+                    stream_.avail_in = take;
+                    consumed_ += take;
+                }
+                auto room = static_cast<uInt>(std::min<size_t>(size - filled, UINT_MAX));
+                stream_.next_out = reinterpret_cast<Bytef*>(data + filled);
+                stream_.avail_out = room;
+                int status = inflate(&stream_, Z_NO_FLUSH);
+                filled += room - stream_.avail_out;
+
+                bool exhausted = stream_.avail_in == 0 && consumed_ == data_.size();
+                if (status == Z_STREAM_END) {
+                    if (exhausted) done_ = true;
+                    else if (inflateReset(&stream_) != Z_OK) throw std::runtime_error("Corrupt gzip data"); // the next member
+                } else if (status == Z_BUF_ERROR && exhausted) {
+                    throw std::runtime_error("Truncated gzip data");
+                } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                    throw std::runtime_error(std::string("Corrupt gzip data: ") + (stream_.msg != nullptr ? stream_.msg : "unknown error"));
+                }
+            }
+            return filled;
+        }
+
+    private:
+        std::string_view data_;
+        size_t consumed_ = 0; // handed to zlib
+        z_stream stream_ {};
+        bool done_ = false;
+    };
+#endif
+
+#if defined(ASM_ANALYZE_ZSTD)
+    /**
+     * Decompresses zstd data, concatenated frames included.
+     */
+    class ZstdReader final : public io::Reader {
+    public:
+        /**
+         * @param data The compressed bytes; they must outlive the reader.
+         */
+        explicit ZstdReader(std::string_view data) : context_(ZSTD_createDCtx()), input_ {data.data(), data.size(), 0} {
+            if (context_ == nullptr) throw std::runtime_error("Cannot initialize zstd");
+        }
+
+        ~ZstdReader() override { ZSTD_freeDCtx(context_); }
+
+        [[nodiscard]] auto read(char* data, size_t size) -> size_t override {
+            ZSTD_outBuffer out {data, size, 0};
+            while (out.pos < out.size) {
+                size_t produced = out.pos;
+                size_t consumed = input_.pos;
+                size_t hint = ZSTD_decompressStream(context_, &out, &input_);
+                if (ZSTD_isError(hint) != 0) throw std::runtime_error(std::string("Corrupt zstd data: ") + ZSTD_getErrorName(hint));
+
+                // Without progress the input is used up; it must end with a complete frame
+                if (out.pos == produced && input_.pos == consumed) {
+                    if (!complete_) throw std::runtime_error("Truncated zstd data");
+                    break;
+                }
+                complete_ = hint == 0;
+            }
+            return out.pos;
+        }
+
+    private:
+        ZSTD_DCtx* context_;
+        ZSTD_inBuffer input_;
+        bool complete_ = false; // whether the last frame read so far is whole
+    };
+#endif
+
+    /**
+     * @param data The compressed bytes; they must outlive the reader.
+     * @return A reader of the decompressed bytes.
+     * @throws std::runtime_error if the codec was not compiled in.
+     */
+    [[nodiscard]] inline auto reader(Codec codec, std::string_view data) -> std::unique_ptr<io::Reader> {
+        stats::totals().compressedRead += data.size();
+        switch (codec) {
+#if defined(ASM_ANALYZE_ZLIB)
+        case GZIP: return std::make_unique<GzipReader>(data);
+#endif
+#if defined(ASM_ANALYZE_ZSTD)
+        case ZSTD: return std::make_unique<ZstdReader>(data);
+#endif
+        default: detail::unavailable(codec);
+        }
+    }
+
+    /**
+     * Decompresses a whole buffer, for the analyses that need all of their source at once.
+     */
+    [[nodiscard]] inline auto decompress(Codec codec, std::string_view data) -> std::string {
+        constexpr size_t READ_SIZE = static_cast<size_t>(1) << 20;
+        std::unique_ptr<io::Reader> in = reader(codec, data);
+        std::string text;
+        for (size_t got = READ_SIZE; got == READ_SIZE;) {
+            size_t size = text.size();
+            text.resize(size + READ_SIZE);
+            got = in->read(text.data() + size, READ_SIZE);
+            text.resize(size + got);
+        }
+        return text;
+    }
+
+    /**
+     * Compresses `text` into self-contained frames, which may be concatenated with others.
+     *
+     * @return The frames, or `text` itself for NONE.
+     * @throws std::runtime_error if the codec was not compiled in.
+     */
+    [[nodiscard]] inline auto frame(Codec codec, std::string&& text) -> std::string {
+        if (codec == NONE || text.empty()) return std::move(text);
+
+        std::string out;
+        switch (codec) {
+#if defined(ASM_ANALYZE_ZLIB)
+        case GZIP:
+            for (size_t offset = 0; offset < text.size(); offset += detail::MEMBER_SIZE)
+                detail::deflateMember(std::string_view(text).substr(offset, detail::MEMBER_SIZE), out);
+            break;
+#endif
+#if defined(ASM_ANALYZE_ZSTD)
+        case ZSTD: {
+            // One context per thread, reused by all of its frames
+            thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+            if (context == nullptr) throw std::runtime_error("Cannot initialize zstd");
+            out.resize(ZSTD_compressBound(text.size()));
+            size_t size = ZSTD_compressCCtx(context.get(), out.data(), out.size(), text.data(), text.size(), ZSTD_CLEVEL_DEFAULT);
+            if (ZSTD_isError(size) != 0) throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(size));
+            out.resize(size);
+            break;
+        }
+#endif
+        default: detail::unavailable(codec);
+        }
+        stats::totals().compressedWritten += out.size();
+        return out;
+    }
+} // namespace compression
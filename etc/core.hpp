@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cfg.hpp>
+
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A namespace for the embedding API of the asm_analyze_core library.
+ *
+ * Everything is analyzed in memory and reported through the results: nothing is
+ * printed, nothing exits, and calls from several threads don't share any state.
+ */
+namespace core {
+    inline constexpr std::string_view VERSION = "0.2.0";
+
+    enum Format : uint8_t {
+        TEXT,    // the annotated text, as written by `asm-analyze`
+        COLUMNAR // the binary columns of `--format columnar`
+    };
+
+    /**
+     * What to produce for each unit.
+     */
+    struct Options {
+        Format format = TEXT;
+        bool crossReference = false; // fill Result::crossReference
+        cfg::Format graph = cfg::NONE; // fill Result::graph
+        bool includes = false; // add the definitions of included files (next to Unit::name) to the cross-reference
+    };
+
+    /**
+     * A buffer to analyze.
+     */
+    struct Unit {
+        std::string name; // recorded as the source path of columnar output
+        std::string_view source; // must stay valid during the call
+    };
+
+    struct Result {
+        std::string output;
+        std::string crossReference;
+        std::string graph;
+        std::string_view architecture; // the detected one, or "unknown"
+        std::string error; // why the unit failed; the outputs are empty then
+
+        [[nodiscard]] explicit operator bool() const { return error.empty(); }
+    };
+
+    /**
+     * Analyzes one buffer.
+     *
+     * @param jobs Worker threads splitting the buffer (1 analyzes it on the calling thread).
+     */
+    [[nodiscard]] auto analyze(const Unit& unit, const Options& options = {}, unsigned jobs = 1) -> Result;
+
+    /**
+     * Analyzes many buffers, several at a time. A failing unit only fails its result.
+     *
+     * @param jobs Worker threads (0 for the hardware concurrency).
+     * @return The results, in the order of `units`.
+     */
+    [[nodiscard]] auto analyzeBatch(const std::vector<Unit>& units, const Options& options = {}, unsigned jobs = 0) -> std::vector<Result>;
+} // namespace core
@@ -1,7 +1,17 @@
 ﻿#pragma once
 
 #include <color.hpp>
+#include <unordered_map>
+#include <string_view>
 #include <iostream>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <string>
+#include <array>
+#include <mutex>
+#include <vector>
 
 /**
   A namespace for debugging-related functionality.
@@ -34,36 +44,267 @@ namespace dbg {
         };
 
         /**
-          Logs a message with the specified level.
+          The stream log messages are written to (stdout unless it carries the analyzed text).
+         */
+        inline std::ostream* output = &std::cout;
+
+        /**
+          The asynchronous backend of log().
+         *
+          Every logging thread owns a lock-free ring buffer it alone writes to; a background
+          thread drains all of them, prefixes the messages and writes each batch at once, so
+          a logging thread never waits for the stream or for another thread. The order of the
+          messages of one thread is kept. Warnings logged more than REPEAT_LIMIT times with the
+          same text are suppressed and counted, and the counts reported (and forgotten) on
+          flush(), or as soon as REPEAT_ENTRIES distinct warnings are being counted.
+         *
+          Messages too large for a ring, and everything logged after stop() (including by a
+          thread that was waiting for room in its ring), are written synchronously instead.
+         */
+        class Logger {
+        public:
+            static constexpr size_t RING_SIZE = static_cast<size_t>(64) << 10;
+            static constexpr uint32_t REPEAT_LIMIT = 3;
+            static constexpr size_t REPEAT_ENTRIES = 1024;
+
+            /**
+              @return The logger, started by the first message. It is never destroyed; exit()
+              stops it (see stop()).
+             */
+            [[nodiscard]] static auto instance() -> Logger& {
+                static Logger* logger = [] {
+                    auto* created = new Logger();
+                    std::atexit([] { instance().stop(); });
+                    return created;
+                }();
+                return *logger;
+            }
+
+            void log(std::string_view message, Level level) {
+                if (!stopped_.load(std::memory_order_acquire) && message.size() + HEADER <= RING_SIZE) {
+                    thread_local std::shared_ptr<Ring> ring;
+                    if (ring == nullptr) ring = attach();
+                    for (;;) {
+                        if (ring->push(message, level)) {
+                            wake();
+                            return;
+                        }
+                        // Full: let the drainer catch up, unless it is gone
+                        if (stopped_.load(std::memory_order_acquire)) break;
+                        wake();
+                        std::this_thread::yield();
+                    }
+                }
+
+                flush();
+                std::lock_guard<std::mutex> lock(write_);
+                std::string line;
+                append(line, message, level);
+                write(line);
+            }
+
+            /**
+              Waits until everything logged so far is written, and reports the suppressed warnings.
+             */
+            void flush() {
+                if (!started_.load(std::memory_order_acquire) || stopped_.load(std::memory_order_acquire)) return;
+                uint64_t request = requested_.fetch_add(1, std::memory_order_acq_rel) + 1;
+                wake();
+                for (uint64_t done = completed_.load(std::memory_order_acquire); done < request; done = completed_.load(std::memory_order_acquire))
+                    completed_.wait(done, std::memory_order_acquire);
+            }
+
+            /**
+              Drains the rings and stops the background thread; later messages are written synchronously.
+             */
+            void stop() {
+                if (!started_.load(std::memory_order_acquire) || stopped_.exchange(true, std::memory_order_acq_rel)) return;
+                wake();
+                if (drainer_.joinable()) {
+                    if (drainer_.get_id() == std::this_thread::get_id()) drainer_.detach();
+                    else drainer_.join();
+                }
+            }
+
+        private:
+            static constexpr size_t HEADER = sizeof(uint32_t) + 1; // size, level
+
+            /**
+              A single-producer, single-consumer byte ring of [u32 size][u8 level][message] records.
+             */
+            class Ring {
+            public:
+                Ring() : data_(std::make_unique<char[]>(RING_SIZE)) {}
+
+                [[nodiscard]] auto push(std::string_view message, Level level) -> bool {
+                    uint64_t head = head_.load(std::memory_order_relaxed);
+                    uint64_t size = HEADER + message.size();
+                    if (size > RING_SIZE - (head - tail_.load(std::memory_order_acquire))) return false;
+                    auto length = static_cast<uint32_t>(message.size());
+                    char header[HEADER];
+                    std::memcpy(header, &length, sizeof(length));
+                    header[sizeof(length)] = static_cast<char>(level);
+                    copyIn(head, header, HEADER);
+                    copyIn(head + HEADER, message.data(), message.size());
+                    head_.store(head + size, std::memory_order_release);
+                    return true;
+                }
+
+                /**
+                  Calls `fn(message, level)` for each record pushed so far.
+                 */
+                template <typename Fn>
+                void drain(std::string& scratch, Fn&& fn) {
+                    uint64_t tail = tail_.load(std::memory_order_relaxed);
+                    uint64_t head = head_.load(std::memory_order_acquire);
+                    while (tail < head) {
+                        char header[HEADER];
+                        copyOut(tail, header, HEADER);
+                        uint32_t length = 0;
+                        std::memcpy(&length, header, sizeof(length));
+                        scratch.resize(length);
+                        copyOut(tail + HEADER, scratch.data(), length);
+                        fn(std::string_view(scratch), static_cast<Level>(header[sizeof(length)]));
+                        tail += HEADER + length;
+                    }
+                    tail_.store(tail, std::memory_order_release);
+                }
+
+                [[nodiscard]] auto empty() const -> bool {
+                    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+                }
+
+            private:
+                void copyIn(uint64_t at, const char* from, size_t size) {
+                    size_t offset = at % RING_SIZE;
+                    size_t first = std::min(size, RING_SIZE - offset);
+                    std::memcpy(data_.get() + offset, from, first);
+                    std::memcpy(data_.get(), from + first, size - first);
+                }
+
+                void copyOut(uint64_t at, char* to, size_t size) const {
+                    size_t offset = at % RING_SIZE;
+                    size_t first = std::min(size, RING_SIZE - offset);
+                    std::memcpy(to, data_.get() + offset, first);
+                    std::memcpy(to + first, data_.get(), size - first);
+                }
+
+                std::unique_ptr<char[]> data_;
+                alignas(64) std::atomic<uint64_t> head_ = 0;
+                alignas(64) std::atomic<uint64_t> tail_ = 0;
+            };
+
+            Logger() {
+                // The prefixes are built once instead of per message
+                constexpr std::array<std::pair<const char*, Color::Code>, FATAL + 1> LEVELS = {{
+                    {"INFO", Color::GREEN}, {"WARN", Color::YELLOW}, {"ERROR", Color::RED}, {"FATAL", Color::RED}
+                }};
+                for (size_t level = 0; level < LEVELS.size(); ++level)
+                    prefixes_[level] = "[" + Color::colorize(LEVELS[level].first, LEVELS[level].second) + "] ";
+            }
+
+            void append(std::string& out, std::string_view message, Level level) const {
+                out += prefixes_[level];
+                out += message;
+                out += '\n';
+            }
+
+            void write(const std::string& text) const {
+                if (text.empty()) return;
+                *output << text;
+                output->flush();
+            }
+
+            /**
+              Registers the ring of the calling thread, starting the drainer with the first one.
+             */
+            [[nodiscard]] auto attach() -> std::shared_ptr<Ring> {
+                auto ring = std::make_shared<Ring>();
+                std::lock_guard<std::mutex> lock(rings_);
+                registered_.push_back(ring);
+                if (!started_.load(std::memory_order_relaxed)) {
+                    drainer_ = std::thread([this] { run(); });
+                    started_.store(true, std::memory_order_release);
+                }
+                return ring;
+            }
+
+            void wake() {
+                pending_.fetch_add(1, std::memory_order_release);
+                pending_.notify_one();
+            }
+
+            void run() {
+                std::string batch;
+                std::string scratch;
+                for (uint64_t seen = 0;;) {
+                    pending_.wait(seen, std::memory_order_acquire);
+                    seen = pending_.load(std::memory_order_acquire);
+                    uint64_t request = requested_.load(std::memory_order_acquire);
+                    bool stopping = stopped_.load(std::memory_order_acquire);
+
+                    {
+                        std::lock_guard<std::mutex> lock(rings_);
+                        for (const std::shared_ptr<Ring>& ring : registered_) {
+                            ring->drain(scratch, [&](std::string_view message, Level level) {
+                                if (level == WARN && ++repeats_[std::string(message)] > REPEAT_LIMIT) return;
+                                append(batch, message, level);
+                            });
+                        }
+                        // The rings of finished threads go once they are empty
+                        std::erase_if(registered_, [](const std::shared_ptr<Ring>& ring) { return ring.use_count() == 1 && ring->empty(); });
+                    }
+                    if (request != reported_ || stopping || repeats_.size() >= REPEAT_ENTRIES) reportRepeats(batch);
+
+                    {
+                        std::lock_guard<std::mutex> lock(write_);
+                        write(batch);
+                    }
+                    batch.clear();
+                    completed_.store(request, std::memory_order_release);
+                    completed_.notify_all();
+                    if (stopping) return;
+                }
+            }
+
+            void reportRepeats(std::string& batch) {
+                reported_ = requested_.load(std::memory_order_acquire);
+                for (const auto& [message, count] : repeats_) {
+                    if (count > REPEAT_LIMIT) append(batch, "(" + std::to_string(count - REPEAT_LIMIT) + " more) " + message, WARN);
+                }
+                repeats_.clear();
+            }
+
+            std::array<std::string, FATAL + 1> prefixes_;
+            std::mutex rings_; // guards registered_; only taken to register a thread and by the drainer
+            std::vector<std::shared_ptr<Ring>> registered_;
+            std::mutex write_; // keeps synchronous lines and batches apart
+            std::thread drainer_;
+            std::atomic<bool> started_ = false;
+            std::atomic<bool> stopped_ = false;
+            std::atomic<uint64_t> pending_ = 0;
+            std::atomic<uint64_t> requested_ = 0;
+            std::atomic<uint64_t> completed_ = 0;
+            uint64_t reported_ = 0; // drainer only
+            std::unordered_map<std::string, uint32_t> repeats_; // drainer only
+        };
+
+        /**
+          Logs a message with the specified level. The message is written asynchronously;
+          see flush().
          *
           @param message The message to log.
           @param level The log level to use (from the Level enum).
          */
         inline const static void log(const std::string& message, Level level) {
-            std::string l{};
-            Color::Code cc = Color::RED;
-
-            switch (level) {
-            case INFO:
-                l = "INFO";
-                cc = Color::GREEN;
-                break;
-            case WARN:
-                l = "WARN";
-                cc = Color::YELLOW;
-                break;
-            case ERR:
-                l = "ERROR";
-                break;
-            case FATAL:
-                l = "FATAL";
-                break;
-            }
-
-            std::string color = Color::colorize(l, cc);
+            Logger::instance().log(message, level);
+        }
 
-            std::cout << "[" << color << "] ";
-            std::cout << message << '\n';
+        /**
+          Waits until every message logged so far is written.
+         */
+        inline static void flush() {
+            Logger::instance().flush();
         }
 
         /**
@@ -104,7 +345,14 @@ namespace dbg {
     } // namespace Debugger
 
     namespace Misc {
+        /**
+          Whether pause() waits for the user (cleared by --no-pause).
+         */
+        inline bool pauseOnExit = true;
+
         inline static void pause() {
+            Debugger::flush();
+            if (!pauseOnExit) return;
           // _WIN32 macro is already defined in x64 Windows
 #if defined(_WIN32) || defined(__WIN32__) || defined(__NT__) && !(defined(__GNUC__) || defined(__clang__)) // Windows without GCC or Clang
             system("pause"); // :cry: ultimate death
@@ -137,6 +385,7 @@ namespace dbg {
          */
         [[noreturn]] inline const static void fexit(const std::string& message, const int& code = 1) {
             Debugger::fatal(message);
+            Debugger::flush();
             pause(); // Now this will work since pause is defined before fexit
             exit(code); // This will terminate the program (wow)
         }
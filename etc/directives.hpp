@@ -0,0 +1,59 @@
+#pragma once
+
+#include <phash.hpp>
+
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+/**
+ * A namespace for the recognized assembler directives.
+ */
+namespace directives {
+    /**
+     * Enumerates the recognized directives.
+     */
+    enum Id : uint8_t {
+        STRING, DATA, BSS, TEXT, GLOBL, GLOBAL, ALIGN, BYTE, WORD, DWORD, QUAD,
+        SECTION, EQU, SET, ORG, RESERVE, SPACE, FILENAME, COMM, END, INCBIN,
+        /**
+         * Not a recognized directive.
+         */
+        NONE
+    };
+
+    /**
+     * A directive name (with its leading '.') and its ID.
+     */
+    struct Directive {
+        std::string_view name;
+        Id id = NONE;
+    };
+
+    inline constexpr std::array DIRECTIVES = {
+        Directive{".string", STRING}, Directive{".data", DATA}, Directive{".bss", BSS}, Directive{".text", TEXT},
+        Directive{".globl", GLOBL}, Directive{".global", GLOBAL}, Directive{".align", ALIGN}, Directive{".byte", BYTE},
+        Directive{".word", WORD}, Directive{".dword", DWORD}, Directive{".quad", QUAD}, Directive{".section", SECTION},
+        Directive{".equ", EQU}, Directive{".set", SET}, Directive{".org", ORG}, Directive{".reserve", RESERVE},
+        Directive{".space", SPACE}, Directive{".file", FILENAME}, Directive{".comm", COMM}, Directive{".end", END},
+        Directive{".incbin", INCBIN}
+    };
+
+    inline constexpr phash::Table TABLE {DIRECTIVES};
+
+    /**
+     * @param name The directive to look up (case-sensitive, with its leading '.').
+     * @return Its ID, or NONE.
+     */
+    [[nodiscard]] constexpr auto lookup(std::string_view name) -> Id {
+        const Directive* directive = TABLE.find(name);
+        return directive == nullptr ? NONE : directive->id;
+    }
+
+    static_assert([] {
+        for (const Directive& directive : DIRECTIVES) {
+            if (lookup(directive.name) != directive.id) return false;
+        }
+        return lookup(".") == NONE && lookup("string") == NONE && lookup(".TEXT") == NONE;
+    }());
+} // namespace directives
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * A namespace for fast non-cryptographic hashing.
+ */
+namespace hash {
+    namespace detail {
+        inline constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+        inline constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+        inline constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+        inline constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+        inline constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+        [[nodiscard]] inline auto rotl(uint64_t x, int r) -> uint64_t {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        [[nodiscard]] inline auto read64(const char* p) -> uint64_t {
+            uint64_t v = 0;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        [[nodiscard]] inline auto read32(const char* p) -> uint32_t {
+            uint32_t v = 0;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        [[nodiscard]] inline auto round(uint64_t acc, uint64_t input) -> uint64_t {
+            acc += input * PRIME2;
+            return rotl(acc, 31) * PRIME1;
+        }
+
+        [[nodiscard]] inline auto merge(uint64_t acc, uint64_t val) -> uint64_t {
+            acc ^= round(0, val);
+            return acc * PRIME1 + PRIME4;
+        }
+    } // namespace detail
+
+    /**
+     * XXH64 of the given bytes (little-endian hosts).
+     *
+     * @param data The bytes to hash.
+     * @param seed The seed.
+     * @return The 64-bit hash.
+     */
+    [[nodiscard]] inline auto xxh64(std::string_view data, uint64_t seed = 0) -> uint64_t {
+        using namespace detail;
+
+        const char* p = data.data();
+        const char* end = p + data.size();
+        uint64_t h = 0;
+
+        if (data.size() >= 32) {
+            uint64_t v1 = seed + PRIME1 + PRIME2;
+            uint64_t v2 = seed + PRIME2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME1;
+            const char* limit = end - 32;
+            do {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(h, v1);
+            h = merge(h, v2);
+            h = merge(h, v3);
+            h = merge(h, v4);
+        } else {
+            h = seed + PRIME5;
+        }
+
+        h += static_cast<uint64_t>(data.size());
+
+        for (; p + 8 <= end; p += 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * PRIME1 + PRIME4;
+        }
+        if (p + 4 <= end) {
+            h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+            h = rotl(h, 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            h ^= static_cast<uint64_t>(static_cast<uint8_t>(*p)) * PRIME5;
+            h = rotl(h, 11) * PRIME1;
+        }
+
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /**
+     * @return The hash as 16 lowercase hex digits.
+     */
+    [[nodiscard]] inline auto hex(uint64_t h) -> std::string {
+        static constexpr char DIGITS[] = "0123456789abcdef";
+        std::string out(16, '0');
+        for (int i = 15; i >= 0; --i, h >>= 4) out[static_cast<size_t>(i)] = DIGITS[h & 0xF];
+        return out;
+    }
+} // namespace hash
@@ -1,26 +1,98 @@
-// Include headers and define functions to use them in main.cpp
+// Include headers and define functions to use them in main.cpp and core.cpp
 
 #pragma once
 
 #include <dbg.hpp>
+#include <input.hpp>
+#include <tokenizer.hpp>
+#include <output.hpp>
+#include <cache.hpp>
+#include <xref.hpp>
+#include <includes.hpp>
+#include <incremental.hpp>
+#include <compression.hpp>
+#include <cfg.hpp>
+#include <columnar.hpp>
+#include <serve.hpp>
+#include <core.hpp>
+#include <stats.hpp>
+#include <archdetect.hpp>
+#include <isa.hpp>
+#include <analysis.hpp>
+#include <memo.hpp>
+#include <parallel.hpp>
 
 #include <unordered_set>
+#include <string_view>
+#include <filesystem>
 #include <algorithm>
+#include <stdexcept>
+#include <sstream>
 #include <fstream>
 #include <iomanip>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <memory>
 #include <vector>
 #include <chrono>
 #include <ctime>
 
 // function prototypes
-[[nodiscard]] auto isInstruction(const std::string& opcode) -> bool;
-[[nodiscard]] auto trim(const std::string& str) -> std::string;
-[[nodiscard]] auto isDirective(const std::string& opcode) -> bool;
-[[nodiscard]] auto getOperand(const std::string& line) -> std::string;
-[[nodiscard]] auto analyzeLine(const std::string& line) -> std::string;
+void analyzeDirectory(const std::string& directory, unsigned jobs, cache::Store* store = nullptr, bool crossReference = false, cfg::Format graph = cfg::NONE, bool columnar = false);
+auto analyzeFile(const std::string& filename, parallel::ThreadPool* pool, const std::string& output = "", cache::Store* store = nullptr, bool crossReference = false, cfg::Format graph = cfg::NONE, bool columnar = false) -> size_t;
+void writeAnalysis(std::string_view source, const std::string& nfilename, parallel::ThreadPool* pool, xref::Index* index = nullptr, cfg::Builder* graph = nullptr, compression::Codec codec = compression::NONE);
+void writeAnalysis(io::Reader& in, const std::string& nfilename, parallel::ThreadPool* pool, xref::Index* index = nullptr, cfg::Builder* graph = nullptr, compression::Codec codec = compression::NONE);
+auto writeAnalysis(std::string_view source, io::OutputFile& newFile, parallel::ThreadPool* pool, xref::Index* index = nullptr, cfg::Builder* graph = nullptr, compression::Codec codec = compression::NONE) -> arch::Isa;
+void writeAppendix(io::OutputFile& out, const xref::Index& index, compression::Codec codec = compression::NONE);
+void writeIncremental(std::string_view source, const std::string& previous, const std::string& nfilename, parallel::ThreadPool* pool, incremental::Index& chunks);
+void writeColumnar(std::string_view source, const std::string& nfilename, std::string_view path, parallel::ThreadPool* pool, xref::Index* index = nullptr, cfg::Builder* graph = nullptr);
+auto writeColumnar(std::string_view source, io::OutputFile& newFile, std::string_view path, parallel::ThreadPool* pool, xref::Index* index = nullptr, cfg::Builder* graph = nullptr) -> arch::Isa;
+auto convertColumnar(const std::string& filename, const std::string& source, const std::string& output) -> uint64_t;
+auto analyzeStream(io::Reader& in, io::OutputFile& out, parallel::ThreadPool* pool, xref::Index* index = nullptr, cfg::Builder* graph = nullptr, compression::Codec codec = compression::NONE) -> size_t;
+void checkPath(const std::string& filename);
+[[nodiscard]] auto isAllowedPath(const std::string& filename) -> bool;
+[[nodiscard]] auto isServedPath(const std::string& filename, bool output) -> bool;
+void serveRequests(const std::string& socketPath, unsigned jobs, cache::Store* store = nullptr, bool crossReference = false, cfg::Format graph = cfg::NONE, bool columnar = false);
+void serveRequest(int fd, cache::Store* store = nullptr, bool crossReference = false, cfg::Format graph = cfg::NONE, bool columnar = false);
+auto analyzeChunk(std::string_view chunk, std::string& out, arch::Isa architecture = arch::UNKNOWN, std::vector<xref::Event>* events = nullptr, columnar::Columns* columns = nullptr) -> uint64_t;
+template <typename Backend>
+auto analyzeChunk(std::string_view chunk, std::string& out, std::vector<xref::Event>* events, columnar::Columns* columns) -> uint64_t;
+auto loadHeader(const std::string& path) -> std::shared_ptr<const includes::Header>;
+auto collectIncludes(std::string_view source, const std::string& filename) -> std::vector<std::shared_ptr<const includes::Header>>;
+auto writeHeader(std::string& header, std::string_view architecture) -> size_t;
+[[nodiscard]] auto isInstruction(std::string_view opcode) -> bool;
+[[nodiscard]] auto trim(std::string_view str) -> std::string_view;
+[[nodiscard]] auto isDirective(std::string_view opcode) -> bool;
+[[nodiscard]] auto getOperand(std::string_view line) -> std::string;
+[[nodiscard]] auto operandSpan(std::string_view line) -> std::string_view;
+[[nodiscard]] auto parseLine(std::string_view line) -> analysis::Record;
+[[nodiscard]] auto parseLine(const scan::Line& tokens, analysis::OperandCache* cache = nullptr) -> analysis::Record;
+[[nodiscard]] auto classifyOperand(std::string_view operand) -> analysis::Operand;
+[[nodiscard]] auto classifyOperand(std::string_view operand, analysis::OperandCache* cache) -> analysis::Operand;
+template <typename Backend>
+[[nodiscard]] auto parseLine(const scan::Line& tokens, analysis::OperandCache* cache) -> analysis::Record;
+template <typename Backend>
+[[nodiscard]] auto parseRiscLine(const scan::Line& tokens, analysis::OperandCache* cache) -> analysis::Record;
+template <typename Backend>
+[[nodiscard]] auto classifyOperand(std::string_view operand) -> analysis::Operand;
+template <typename Backend>
+[[nodiscard]] auto classifyOperand(std::string_view operand, analysis::OperandCache* cache) -> analysis::Operand;
+void parseInstruction(analysis::Record& record, scan::Split split, analysis::OperandCache* cache = nullptr);
+void formatComment(const analysis::Record& record, std::string& out);
+template <typename Backend>
+void formatComment(const analysis::Record& record, std::string& out);
+void formatInstruction(const analysis::Record& record, std::string& out);
+void formatRiscInstruction(const analysis::Record& record, std::string& out);
+void formatRiscBranch(const analysis::Record& record, std::string_view condition, std::string_view zero, std::string_view flags, std::string& out);
+void formatRiscOperands(const analysis::Record& record, size_t begin, size_t end, std::string& out);
+void formatDirective(const analysis::Record& record, std::string& out);
+void formatOperand(const analysis::Operand& operand, bool appendType, std::string& out);
+void appendLower(std::string& out, std::string_view text);
+[[nodiscard]] auto analyzeLine(std::string_view line) -> std::string;
 [[nodiscard]] auto analyzeOperands(std::string& operands) -> std::string;
-[[nodiscard]] auto isMemoryAddressingMode(const std::string& operand) -> bool;
-[[nodiscard]] auto getArchitecture(const std::string& filename) -> std::string;
+[[nodiscard]] auto isMemoryAddressingMode(std::string_view operand) -> bool;
+[[nodiscard]] auto getArchitecture(std::string_view source) -> std::string;
 [[nodiscard]] auto analyzeOperand(std::string& operand, bool appendType = false) -> std::string;
 [[nodiscard]] auto analyzeDirective(const std::string& opcode, const std::string& operand) -> std::string;
-[[nodiscard]] auto analyzeInstruction(const std::string& opcode, const std::string& operands, const std::string& line) -> std::string;
\ No newline at end of file
+[[nodiscard]] auto analyzeInstruction(opcodes::Id id, const std::string& opcode, const std::string& operands, std::string_view line) -> std::string;
\ No newline at end of file
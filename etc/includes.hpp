@@ -0,0 +1,217 @@
+#pragma once
+
+#include <stats.hpp>
+#include <xref.hpp>
+#include <hash.hpp>
+
+#include <unordered_map>
+#include <string_view>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+
+/**
+ * A namespace for following `.include`, `%include`, `#include` and `include` directives.
+ *
+ * Included headers are analyzed once per run and shared: the process-wide Cache maps
+ * a header's canonical path to its analysis, which every file including it reuses.
+ * An entry is checked against the header's modification time and size on each use,
+ * so a long-running daemon picks up edited headers. Concurrent users of a header that
+ * is not analyzed yet wait for the one thread analyzing it.
+ */
+namespace includes {
+    namespace fs = std::filesystem;
+
+    /**
+     * Whether the analyzed files' includes are followed (set by --includes).
+     */
+    inline bool follow = false;
+
+    /**
+     * An include directive of a source.
+     */
+    struct Directive {
+        uint64_t line = 0; // 1-based
+        std::string_view path; // as written, without quotes or angle brackets
+    };
+
+    /**
+     * A header, analyzed. Immutable once published, so it is shared without locking.
+     */
+    struct Header {
+        std::string path; // canonical
+        std::string source;
+        uint64_t hash = 0; // of the source
+        std::vector<xref::Event> events; // views into `source`
+        std::vector<std::string> includes; // the canonical paths of the headers it includes
+    };
+
+    /**
+     * @return The include directives of `source`, in line order.
+     */
+    [[nodiscard]] inline auto scan(std::string_view source) -> std::vector<Directive> {
+        std::vector<Directive> directives;
+        if (source.find("include") == std::string_view::npos && source.find("INCLUDE") == std::string_view::npos) return directives;
+
+        uint64_t line = 0;
+        for (size_t begin = 0; begin < source.size();) {
+            size_t end = source.find('\n', begin);
+            if (end == std::string_view::npos) end = source.size();
+            std::string_view text = source.substr(begin, end - begin);
+            begin = end + 1;
+            ++line;
+
+            size_t first = text.find_first_not_of(" \t");
+            if (first == std::string_view::npos) continue;
+            text.remove_prefix(first);
+            if (text[0] == '.' || text[0] == '%' || text[0] == '#') text.remove_prefix(1);
+            if (text.size() < 8) continue;
+            std::string keyword(text.substr(0, 7));
+            std::transform(keyword.begin(), keyword.end(), keyword.begin(), [](char c) { return static_cast<char>(c | 0x20); });
+            if (keyword != "include" || (text[7] != ' ' && text[7] != '\t')) continue;
+
+            text.remove_prefix(8);
+            text.remove_prefix(std::min(text.find_first_not_of(" \t"), text.size()));
+            if (text.empty()) continue;
+            char close = text[0] == '"' ? '"' : text[0] == '\'' ? '\'' : text[0] == '<' ? '>' : '\0';
+            std::string_view path;
+            if (close != '\0') {
+                size_t last = text.find(close, 1);
+                if (last == std::string_view::npos) continue;
+                path = text.substr(1, last - 1);
+            } else {
+                path = text.substr(0, text.find_first_of(" \t\r;"));
+            }
+            if (!path.empty()) directives.push_back({line, path});
+        }
+        return directives;
+    }
+
+    /**
+     * Resolves an include the way assemblers do: next to the including file, then in
+     * the working directory.
+     *
+     * @param directory The directory of the including file.
+     * @return The canonical path of the header, or "" if there is none.
+     */
+    [[nodiscard]] inline auto resolve(std::string_view path, const fs::path& directory) -> std::string {
+        std::error_code ec;
+        for (const fs::path& candidate : {directory / fs::path(path), fs::path(path)}) {
+            if (!fs::is_regular_file(candidate, ec)) continue;
+            fs::path canonical = fs::canonical(candidate, ec);
+            if (!ec) return canonical.string();
+        }
+        return {};
+    }
+
+    /**
+     * The analyzed headers of a run.
+     */
+    class Cache {
+    public:
+        /**
+         * @param path The canonical path of a header.
+         * @param load Analyzes the header: `std::shared_ptr<const Header>(const std::string& path)`,
+         *             or nullptr if it cannot be read.
+         * @return The analysis of the header, or nullptr.
+         */
+        template <typename Load>
+        [[nodiscard]] auto get(const std::string& path, Load&& load) -> std::shared_ptr<const Header> {
+            std::error_code timeError;
+            std::error_code sizeError;
+            Stamp stamp {fs::last_write_time(path, timeError), fs::file_size(path, sizeError)};
+            if (timeError || sizeError) return nullptr;
+
+            std::promise<std::shared_ptr<const Header>> promise;
+            std::shared_future<std::shared_ptr<const Header>> future;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Entry& entry = entries_[path];
+                if (!entry.future.valid() || entry.stamp != stamp) entry = {stamp, promise.get_future().share()};
+                else future = entry.future;
+            }
+            if (future.valid()) {
+                ++stats::totals().headersReused;
+                return future.get();
+            }
+
+            ++stats::totals().headers;
+            std::shared_ptr<const Header> header;
+            try {
+                header = load(path);
+            } catch (...) {
+                header = nullptr;
+            }
+            promise.set_value(header);
+            return header;
+        }
+
+    private:
+        struct Stamp {
+            fs::file_time_type time;
+            uintmax_t size = 0;
+
+            [[nodiscard]] auto operator==(const Stamp& other) const -> bool = default;
+        };
+
+        struct Entry {
+            Stamp stamp;
+            std::shared_future<std::shared_ptr<const Header>> future;
+        };
+
+        std::mutex mutex_;
+        std::unordered_map<std::string, Entry> entries_;
+    };
+
+    /**
+     * @return The cache shared by every analysis of the process.
+     */
+    [[nodiscard]] inline auto shared() -> Cache& {
+        static Cache instance;
+        return instance;
+    }
+
+    /**
+     * Collects the headers a source includes, directly or not, each once.
+     *
+     * @param source The including source.
+     * @param directory Its directory.
+     * @param load See Cache::get().
+     * @return The headers, in the order they are first included.
+     */
+    template <typename Load>
+    [[nodiscard]] auto collect(std::string_view source, const fs::path& directory, Load&& load) -> std::vector<std::shared_ptr<const Header>> {
+        std::vector<std::shared_ptr<const Header>> headers;
+        std::vector<std::string> pending;
+        for (const Directive& directive : scan(source)) {
+            std::string path = resolve(directive.path, directory);
+            if (!path.empty()) pending.push_back(std::move(path));
+        }
+
+        std::vector<std::string> seen;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (std::find(seen.begin(), seen.end(), pending[i]) != seen.end()) continue;
+            seen.push_back(pending[i]);
+            std::shared_ptr<const Header> header = shared().get(pending[i], load);
+            if (header == nullptr) continue;
+            pending.insert(pending.end(), header->includes.begin(), header->includes.end());
+            headers.push_back(std::move(header));
+        }
+        return headers;
+    }
+
+    /**
+     * @return A hash of the given headers' paths and contents, for cache keys.
+     */
+    [[nodiscard]] inline auto fingerprint(const std::vector<std::shared_ptr<const Header>>& headers) -> uint64_t {
+        uint64_t h = 0;
+        for (const std::shared_ptr<const Header>& header : headers)
+            h = hash::xxh64(header->path, h ^ header->hash);
+        return h;
+    }
+} // namespace includes
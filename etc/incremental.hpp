@@ -0,0 +1,237 @@
+#pragma once
+
+#include <archdetect.hpp>
+#include <input.hpp>
+#include <hash.hpp>
+
+#include <unordered_map>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <array>
+
+/**
+ * A namespace for incremental re-analysis.
+ *
+ * The input is cut into content-defined chunks: a gear rolling hash picks the cut
+ * points from the bytes around them, so an edit only moves the boundaries next to
+ * it and every other chunk keeps its bytes and its hash. An index written next to
+ * the output (OUTPUT.idx) maps each chunk's hash to the range of the output it
+ * produced. The next run analyzes the chunks the index doesn't know and copies the
+ * others from the previous output.
+ *
+ * The index is only trusted when the analyzer version, the architecture (which picks
+ * the backend) and the previous output (its size and header) still match it.
+ *
+ * Layout (little-endian):
+ *
+ *     offset  size  field
+ *          0     8  magic "ASMIDX1\0"
+ *          8     4  layout version
+ *         12     1  architecture
+ *         13     3  reserved
+ *         16     8  output size
+ *         24     4  analyzer version size
+ *         28     4  output header size
+ *         32     8  entry count N
+ *         40        the analyzer version, the output header, Entry[N] (5 u64 each)
+ */
+namespace incremental {
+    /**
+     * Whether analyzed files are re-analyzed incrementally (set by --incremental).
+     */
+    inline bool enabled = false;
+
+    inline constexpr std::string_view EXTENSION = ".idx";
+
+    inline constexpr std::string_view MAGIC {"ASMIDX1\0", 8};
+
+    inline constexpr uint32_t VERSION = 1;
+
+    /**
+     * Chunk sizes: cuts are only looked for past MIN_CHUNK, forced at MAX_CHUNK, and
+     * otherwise made with a probability of 1 / 2^15 per byte (always at a line end).
+     */
+    inline constexpr size_t MIN_CHUNK = static_cast<size_t>(16) << 10;
+    inline constexpr size_t MAX_CHUNK = static_cast<size_t>(256) << 10;
+    inline constexpr uint64_t MASK = ~(~static_cast<uint64_t>(0) >> 15); // the top bits, which depend on the last 64 bytes
+
+    /**
+     * A chunk of the input, ending at a line end (or at the end of the input).
+     */
+    struct Chunk {
+        std::string_view text;
+        uint64_t hash = 0;
+    };
+
+    /**
+     * What a chunk produced in the previous run.
+     */
+    struct Entry {
+        uint64_t hash = 0;
+        uint64_t inputSize = 0;
+        uint64_t outputOffset = 0;
+        uint64_t outputSize = 0;
+        uint64_t lines = 0;
+    };
+
+    namespace detail {
+        /**
+         * Random 64-bit values per byte (splitmix64).
+         */
+        inline constexpr std::array<uint64_t, 256> GEAR = [] {
+            std::array<uint64_t, 256> gear {};
+            uint64_t state = 0x9E3779B97F4A7C15ULL;
+            for (uint64_t& value : gear) {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                value = z ^ (z >> 31);
+            }
+            return gear;
+        }();
+
+        [[nodiscard]] inline auto read64(const char* p) -> uint64_t {
+            uint64_t value = 0;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        [[nodiscard]] inline auto read32(const char* p) -> uint32_t {
+            uint32_t value = 0;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline void append(std::string& out, uint64_t value, size_t size) {
+            char bytes[sizeof(value)];
+            std::memcpy(bytes, &value, sizeof(value));
+            out.append(bytes, size);
+        }
+    } // namespace detail
+
+    /**
+     * Cuts `source` into content-defined chunks.
+     */
+    [[nodiscard]] inline auto split(std::string_view source) -> std::vector<Chunk> {
+        std::vector<Chunk> chunks;
+        size_t begin = 0;
+        while (begin < source.size()) {
+            size_t end = source.size();
+            if (end - begin > MIN_CHUNK) {
+                // The gear hash only sees the last 64 bytes, so it starts that far before MIN_CHUNK
+                size_t limit = std::min(end, begin + MAX_CHUNK);
+                uint64_t h = 0;
+                size_t cut = limit;
+                for (size_t i = begin + MIN_CHUNK - 64; i < limit; ++i) {
+                    h = (h << 1) + detail::GEAR[static_cast<uint8_t>(source[i])];
+                    if (i >= begin + MIN_CHUNK && (h & MASK) == 0) {
+                        cut = i;
+                        break;
+                    }
+                }
+                size_t newline = source.find('\n', cut == limit ? limit - 1 : cut);
+                end = newline == std::string_view::npos ? source.size() : newline + 1;
+            }
+            std::string_view text = source.substr(begin, end - begin);
+            chunks.push_back({text, hash::xxh64(text)});
+            begin = end;
+        }
+        return chunks;
+    }
+
+    /**
+     * The chunks of a previous run and where their output is.
+     */
+    class Index {
+    public:
+        std::string version; // of the analyzer
+        arch::Isa architecture = arch::UNKNOWN;
+        std::string header; // the header of the output
+        uint64_t outputSize = 0;
+        std::vector<Entry> entries;
+
+        /**
+         * Reads an index; an unreadable, foreign or corrupt one (an entry whose output lies
+         * past the recorded output size) leaves it empty.
+         */
+        [[nodiscard]] static auto load(const std::string& path) -> Index {
+            Index index;
+            io::InputFile file(path);
+            if (!file) return index;
+            std::string_view data = file.view();
+            if (data.size() < 40 || data.substr(0, MAGIC.size()) != MAGIC || detail::read32(data.data() + 8) != VERSION) return index;
+
+            uint32_t versionSize = detail::read32(data.data() + 24);
+            uint32_t headerSize = detail::read32(data.data() + 28);
+            uint64_t count = detail::read64(data.data() + 32);
+            constexpr uint64_t ENTRY_SIZE = 5 * sizeof(uint64_t);
+            if (count > data.size() / ENTRY_SIZE || data.size() != 40 + static_cast<uint64_t>(versionSize) + headerSize + count * ENTRY_SIZE) return index;
+
+            index.architecture = static_cast<arch::Isa>(data[12]);
+            index.outputSize = detail::read64(data.data() + 16);
+            index.version = data.substr(40, versionSize);
+            index.header = data.substr(40 + versionSize, headerSize);
+            const char* at = data.data() + 40 + versionSize + headerSize;
+            index.entries.resize(count);
+            for (Entry& entry : index.entries) {
+                entry = {detail::read64(at), detail::read64(at + 8), detail::read64(at + 16), detail::read64(at + 24), detail::read64(at + 32)};
+                at += ENTRY_SIZE;
+                if (entry.outputOffset > index.outputSize || entry.outputSize > index.outputSize - entry.outputOffset) return Index();
+            }
+            index.build();
+            return index;
+        }
+
+        /**
+         * Appends the serialized index to `out`.
+         */
+        void write(std::string& out) const {
+            out += MAGIC;
+            detail::append(out, VERSION, 4);
+            detail::append(out, architecture, 4);
+            detail::append(out, outputSize, 8);
+            detail::append(out, version.size(), 4);
+            detail::append(out, header.size(), 4);
+            detail::append(out, entries.size(), 8);
+            out += version;
+            out += header;
+            for (const Entry& entry : entries) {
+                detail::append(out, entry.hash, 8);
+                detail::append(out, entry.inputSize, 8);
+                detail::append(out, entry.outputOffset, 8);
+                detail::append(out, entry.outputSize, 8);
+                detail::append(out, entry.lines, 8);
+            }
+        }
+
+        /**
+         * @return Whether the index describes `output`, as produced by analyzer `currentVersion`
+         *         for `currentArchitecture`.
+         */
+        [[nodiscard]] auto matches(std::string_view output, std::string_view currentVersion, arch::Isa currentArchitecture) const -> bool {
+            return !entries.empty() && version == currentVersion && architecture == currentArchitecture && output.size() == outputSize
+                && output.substr(0, header.size()) == header;
+        }
+
+        /**
+         * @return The entry of a chunk with these contents, or nullptr.
+         */
+        [[nodiscard]] auto find(const Chunk& chunk) const -> const Entry* {
+            auto it = byHash_.find(chunk.hash);
+            if (it == byHash_.end()) return nullptr;
+            const Entry& entry = entries[it->second];
+            return entry.inputSize == chunk.text.size() ? &entry : nullptr;
+        }
+
+    private:
+        void build() {
+            byHash_.reserve(entries.size());
+            for (size_t i = 0; i < entries.size(); ++i) byHash_.emplace(entries[i].hash, i);
+        }
+
+        std::unordered_map<uint64_t, size_t> byHash_;
+    };
+} // namespace incremental
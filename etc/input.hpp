@@ -0,0 +1,195 @@
+#pragma once
+
+#include <string_view>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <array>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A namespace for input/output helpers.
+ */
+namespace io {
+    /**
+     * A read-only, zero-copy view over an input file.
+     *
+     * Regular files are memory-mapped once and advised for sequential access,
+     * so reading costs little more than the page faults. Pipes, character devices
+     * and platforms without mmap fall back to a buffered stream read.
+     */
+    class InputFile {
+    public:
+        /**
+         * Opens (and maps, when possible) the given file.
+         *
+         * @param path The path of the file to open.
+         */
+        explicit InputFile(const std::string& path) {
+#if !defined(_WIN32) && !defined(_WIN64)
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat st {};
+            if (::fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+                ::close(fd);
+                return;
+            }
+
+            if (S_ISREG(st.st_mode)) {
+                size_ = static_cast<size_t>(st.st_size);
+                if (size_ > 0) {
+                    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (addr != MAP_FAILED) {
+                        ::madvise(addr, size_, MADV_SEQUENTIAL);
+                        ::madvise(addr, size_, MADV_WILLNEED);
+                        data_ = static_cast<const char*>(addr);
+                        mapped_ = true;
+                    }
+                }
+                ::close(fd);
+                if (mapped_ || size_ == 0) {
+                    good_ = true;
+                    return;
+                }
+                size_ = 0;
+            } else {
+                ::close(fd);
+            }
+#endif
+            readStream(path);
+        }
+
+        InputFile(const InputFile&) = delete;
+        auto operator=(const InputFile&) -> InputFile& = delete;
+
+        InputFile(InputFile&& other) noexcept
+            : buffer_(std::move(other.buffer_)), data_(other.data_), size_(other.size_),
+              mapped_(other.mapped_), good_(other.good_) {
+            if (!mapped_) data_ = buffer_.data();
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.mapped_ = false;
+            other.good_ = false;
+        }
+
+        auto operator=(InputFile&&) -> InputFile& = delete;
+
+        ~InputFile() {
+#if !defined(_WIN32) && !defined(_WIN64)
+            if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+
+        /**
+         * @return Whether the file was opened successfully.
+         */
+        [[nodiscard]] explicit operator bool() const { return good_; }
+
+        /**
+         * @return Whether the contents are backed by a memory mapping.
+         */
+        [[nodiscard]] auto mapped() const -> bool { return mapped_; }
+
+        /**
+         * @return The whole file contents.
+         */
+        [[nodiscard]] auto view() const -> std::string_view { return {data_, size_}; }
+
+    private:
+        void readStream(const std::string& path) {
+            std::ifstream stream(path);
+            if (!stream) return;
+
+            std::array<char, 1 << 16> chunk {};
+            while (stream.read(chunk.data(), chunk.size()) || stream.gcount() > 0) {
+                buffer_.append(chunk.data(), static_cast<size_t>(stream.gcount()));
+            }
+
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            good_ = !stream.bad();
+        }
+
+        std::string buffer_;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;
+        bool good_ = false;
+    };
+
+    /**
+     * A source of bytes read a chunk at a time (stdin, or a decompressed file).
+     */
+    class Reader {
+    public:
+        Reader() = default;
+        Reader(const Reader&) = delete;
+        auto operator=(const Reader&) -> Reader& = delete;
+        Reader(Reader&&) = delete;
+        auto operator=(Reader&&) -> Reader& = delete;
+        virtual ~Reader() = default;
+
+        /**
+         * Reads the next bytes.
+         *
+         * @return The number of bytes read, which is `size` unless the input ended.
+         * @throws std::runtime_error if the input cannot be read.
+         */
+        [[nodiscard]] virtual auto read(char* data, size_t size) -> size_t = 0;
+    };
+
+    /**
+     * Reads a std::istream.
+     */
+    class StreamReader final : public Reader {
+    public:
+        explicit StreamReader(std::istream& in) : in_(in) {}
+
+        [[nodiscard]] auto read(char* data, size_t size) -> size_t override {
+            in_.read(data, static_cast<std::streamsize>(size));
+            return static_cast<size_t>(in_.gcount());
+        }
+
+    private:
+        std::istream& in_;
+    };
+
+    /**
+     * Splits text into lines without copying, following std::getline semantics:
+     * the '\n' terminator is dropped and no empty line follows a trailing newline.
+     */
+    class LineReader {
+    public:
+        /**
+         * @param text The text to split.
+         */
+        explicit LineReader(std::string_view text) : text_(text) {}
+
+        /**
+         * Reads the next line.
+         *
+         * @param line Receives a view of the line (without the terminator).
+         * @return False once the end of the text has been reached.
+         */
+        [[nodiscard]] auto next(std::string_view& line) -> bool {
+            if (pos_ >= text_.size()) return false;
+
+            size_t end = text_.find('\n', pos_);
+            if (end == std::string_view::npos) end = text_.size();
+
+            line = text_.substr(pos_, end - pos_);
+            pos_ = end + 1;
+            return true;
+        }
+
+    private:
+        std::string_view text_;
+        size_t pos_ = 0;
+    };
+} // namespace io
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <hash.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <memory>
+#include <vector>
+
+/**
+ * A namespace for interned strings and the arena they live in.
+ */
+namespace intern {
+    /**
+     * A bump allocator. Memory is handed out from large blocks and only given
+     * back all at once, by reset() (which keeps the blocks for reuse) or by the
+     * destructor.
+     */
+    class Arena {
+    public:
+        /**
+         * @param blockSize The size of the blocks requested from the system.
+         */
+        explicit Arena(size_t blockSize = static_cast<size_t>(64) << 10) : blockSize_(blockSize) {}
+
+        Arena(const Arena&) = delete;
+        auto operator=(const Arena&) -> Arena& = delete;
+
+        /**
+         * @return `size` bytes aligned to `alignment` (a power of two), valid until reset().
+         */
+        [[nodiscard]] auto allocate(size_t size, size_t alignment = alignof(std::max_align_t)) -> void* {
+            for (;;) {
+                if (current_ < blocks_.size()) {
+                    Block& block = blocks_[current_];
+                    size_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+                    if (offset + size <= block.size) {
+                        offset_ = offset + size;
+                        used_ += size;
+                        return block.data.get() + offset;
+                    }
+                    ++current_;
+                    offset_ = 0;
+                    continue;
+                }
+
+                // Oversized requests get a block of their own
+                size_t capacity = std::max(blockSize_, size + alignment);
+                blocks_.push_back({std::make_unique<char[]>(capacity), capacity});
+            }
+        }
+
+        /**
+         * @return A copy of `text` in the arena.
+         */
+        [[nodiscard]] auto copy(std::string_view text) -> std::string_view {
+            if (text.empty()) return {};
+            auto* data = static_cast<char*>(allocate(text.size(), 1));
+            std::memcpy(data, text.data(), text.size());
+            return {data, text.size()};
+        }
+
+        /**
+         * Releases everything allocated so far in one shot.
+         */
+        void reset() {
+            current_ = 0;
+            offset_ = 0;
+            used_ = 0;
+        }
+
+        /**
+         * @return The number of bytes handed out since the last reset().
+         */
+        [[nodiscard]] auto used() const -> size_t { return used_; }
+
+    private:
+        struct Block {
+            std::unique_ptr<char[]> data;
+            size_t size = 0;
+        };
+
+        std::vector<Block> blocks_;
+        size_t blockSize_;
+        size_t current_ = 0;
+        size_t offset_ = 0;
+        size_t used_ = 0;
+    };
+
+    /**
+     * An interned string's ID: its index in the table, in order of first appearance.
+     */
+    using Id = uint32_t;
+
+    inline constexpr Id NONE = UINT32_MAX;
+
+    /**
+     * Maps strings to dense IDs, with one canonical copy of each string (in an arena)
+     * and a value per ID.
+     *
+     * Lookups hash the string once and probe an open-addressed slot array; the stored
+     * hash is compared before the text.
+     *
+     * @tparam Value The data kept per string.
+     */
+    template <typename Value>
+    class Table {
+    public:
+        /**
+         * @param arena Where the canonical copies are stored; they live as long as the arena is not reset.
+         */
+        explicit Table(Arena& arena) : arena_(arena), slots_(INITIAL_SLOTS, NONE) {}
+
+        /**
+         * Interns `text`.
+         *
+         * @return Its ID, and whether it was seen for the first time (its value is then default-constructed).
+         */
+        auto intern(std::string_view text) -> std::pair<Id, bool> {
+            uint64_t h = hash::xxh64(text);
+            size_t slot = probe(text, h);
+            if (slots_[slot] != NONE) return {slots_[slot], false};
+
+            auto id = static_cast<Id>(entries_.size());
+            entries_.push_back({arena_.copy(text), h, Value()});
+            slots_[slot] = id;
+            if (entries_.size() * 4 > slots_.size() * 3) grow();
+            return {id, true};
+        }
+
+        /**
+         * @return The ID of `text`, or NONE if it was never interned.
+         */
+        [[nodiscard]] auto find(std::string_view text) const -> Id {
+            return slots_[probe(text, hash::xxh64(text))];
+        }
+
+        [[nodiscard]] auto text(Id id) const -> std::string_view { return entries_[id].text; }
+
+        [[nodiscard]] auto value(Id id) -> Value& { return entries_[id].value; }
+
+        [[nodiscard]] auto value(Id id) const -> const Value& { return entries_[id].value; }
+
+        [[nodiscard]] auto size() const -> size_t { return entries_.size(); }
+
+        /**
+         * Forgets every string but keeps the capacity. The arena is reset separately.
+         */
+        void clear() {
+            entries_.clear();
+            std::fill(slots_.begin(), slots_.end(), NONE);
+        }
+
+    private:
+        static constexpr size_t INITIAL_SLOTS = 1024;
+
+        struct Entry {
+            std::string_view text;
+            uint64_t hash = 0;
+            Value value;
+        };
+
+        /**
+         * @return The slot holding `text`, or the empty slot where it belongs.
+         */
+        [[nodiscard]] auto probe(std::string_view text, uint64_t h) const -> size_t {
+            size_t mask = slots_.size() - 1;
+            for (size_t slot = h & mask;; slot = (slot + 1) & mask) {
+                Id id = slots_[slot];
+                if (id == NONE) return slot;
+                const Entry& entry = entries_[id];
+                if (entry.hash == h && entry.text == text) return slot;
+            }
+        }
+
+        void grow() {
+            slots_.assign(slots_.size() * 2, NONE);
+            size_t mask = slots_.size() - 1;
+            for (size_t id = 0; id < entries_.size(); ++id) {
+                size_t slot = entries_[id].hash & mask;
+                while (slots_[slot] != NONE) slot = (slot + 1) & mask;
+                slots_[slot] = static_cast<Id>(id);
+            }
+        }
+
+        Arena& arena_;
+        std::vector<Entry> entries_;
+        std::vector<Id> slots_;
+    };
+} // namespace intern
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <archdetect.hpp>
+#include <registers.hpp>
+#include <tokenizer.hpp>
+#include <opcodes.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <array>
+
+/**
+ * A namespace for the per-architecture analyzer backends.
+ *
+ * A backend is a policy the analysis loop is instantiated with (see analyzeChunk()),
+ * so the architecture is looked at once per chunk and never per line. It provides:
+ *
+ *     RISC              the line syntax: false for the original x86 one (fields split
+ *                       at spaces, two-operand forms), true for the comma-separated
+ *                       operand lists of the load/store architectures
+ *     opcode(name)      the operation of a mnemonic (lowercase for RISC backends)
+ *     reg(name)         the register of a lowercase name, or nullptr
+ *     REGISTER_WIDTH    the length of the longest register name
+ *     immediate(text)   whether an operand is an immediate
+ *     memory(text)      whether an operand is a memory reference
+ *     comment(line)     where a RISC line's comment starts (npos if it has none)
+ *
+ * Architectures without a backend of their own are analyzed as x86.
+ */
+namespace isa {
+    namespace detail {
+        template <typename Entry, size_t N>
+        [[nodiscard]] constexpr auto nameWidth(const std::array<Entry, N>& table) -> size_t {
+            size_t width = 0;
+            for (const Entry& entry : table) width = std::max(width, entry.name.size());
+            return width;
+        }
+
+        /**
+         * @return Whether the operand is a number, optionally negative.
+         */
+        [[nodiscard]] constexpr auto isNumber(std::string_view operand) -> bool {
+            if (!operand.empty() && operand[0] == '-') operand.remove_prefix(1);
+            return !operand.empty() && operand[0] >= '0' && operand[0] <= '9';
+        }
+
+        /**
+         * @return Whether the operand is `offset(base)` with a register base, as
+         *         opposed to the argument list of a relocation such as `%lo(symbol)`.
+         */
+        template <typename Backend>
+        [[nodiscard]] inline auto isBaseOffset(std::string_view operand) -> bool {
+            if (operand.empty() || operand.back() != ')') return false;
+            size_t open = operand.rfind('(');
+            if (open == std::string_view::npos) return false;
+            std::string_view base = operand.substr(open + 1, operand.size() - open - 2);
+            if (base.empty() || base.size() > Backend::REGISTER_WIDTH) return false;
+            std::array<char, Backend::REGISTER_WIDTH> lower {};
+            scan::lower(base, lower.data());
+            return Backend::reg(std::string_view(lower.data(), base.size())) != nullptr;
+        }
+
+        /**
+         * @return Where the first comment marker outside a string literal starts, or npos.
+         */
+        [[nodiscard]] constexpr auto findComment(std::string_view line, std::string_view markers, bool slashes) -> size_t {
+            bool quoted = false;
+            for (size_t i = 0; i < line.size(); ++i) {
+                char c = line[i];
+                if (quoted) {
+                    if (c == '\\') ++i;
+                    else if (c == '"') quoted = false;
+                } else if (c == '"') {
+                    quoted = true;
+                } else if (markers.find(c) != std::string_view::npos || (slashes && c == '/' && i + 1 < line.size() && line[i + 1] == '/')) {
+                    return i;
+                }
+            }
+            return std::string_view::npos;
+        }
+    } // namespace detail
+
+    /**
+     * x86: the original analysis, kept byte for byte.
+     */
+    struct X86 {
+        static constexpr bool RISC = false;
+        static constexpr size_t REGISTER_WIDTH = registers::NAME_WIDTH;
+
+        [[nodiscard]] static constexpr auto opcode(std::string_view name) -> opcodes::Id { return opcodes::lookup(name); }
+        [[nodiscard]] static constexpr auto reg(std::string_view name) -> const registers::Register* { return registers::lookup(name); }
+
+        [[nodiscard]] static constexpr auto immediate(std::string_view operand) -> bool {
+            return operand[0] == '$' || (operand[0] >= '0' && operand[0] <= '9');
+        }
+
+        [[nodiscard]] static constexpr auto memory(std::string_view operand) -> bool {
+            return !operand.empty() && operand[0] == '[' && operand.back() == ']' && operand.find('%') != std::string_view::npos;
+        }
+    };
+
+    /**
+     * ARM (AArch32 and AArch64): `#` immediates, `=` literals and `[base, offset]`.
+     */
+    struct Arm {
+        static constexpr bool RISC = true;
+        static constexpr size_t REGISTER_WIDTH = registers::arm::NAME_WIDTH;
+        static constexpr size_t MNEMONIC_WIDTH = detail::nameWidth(opcodes::arm::MNEMONICS);
+
+        [[nodiscard]] static constexpr auto opcode(std::string_view name) -> opcodes::Id { return opcodes::arm::lookup(name); }
+        [[nodiscard]] static constexpr auto reg(std::string_view name) -> const registers::Register* { return registers::arm::lookup(name); }
+
+        [[nodiscard]] static constexpr auto immediate(std::string_view operand) -> bool {
+            return operand[0] == '#' || operand[0] == '=' || detail::isNumber(operand);
+        }
+
+        [[nodiscard]] static constexpr auto memory(std::string_view operand) -> bool { return operand[0] == '['; }
+
+        [[nodiscard]] static constexpr auto comment(std::string_view line) -> size_t { return detail::findComment(line, "@", true); }
+    };
+
+    /**
+     * RISC-V: bare immediates, `offset(base)` and `#` comments.
+     */
+    struct RiscV {
+        static constexpr bool RISC = true;
+        static constexpr size_t REGISTER_WIDTH = registers::riscv::NAME_WIDTH;
+        static constexpr size_t MNEMONIC_WIDTH = detail::nameWidth(opcodes::riscv::MNEMONICS);
+
+        [[nodiscard]] static constexpr auto opcode(std::string_view name) -> opcodes::Id { return opcodes::riscv::lookup(name); }
+        [[nodiscard]] static constexpr auto reg(std::string_view name) -> const registers::Register* { return registers::riscv::lookup(name); }
+        [[nodiscard]] static constexpr auto immediate(std::string_view operand) -> bool { return detail::isNumber(operand); }
+        [[nodiscard]] static auto memory(std::string_view operand) -> bool { return detail::isBaseOffset<RiscV>(operand); }
+        [[nodiscard]] static constexpr auto comment(std::string_view line) -> size_t { return detail::findComment(line, "#", false); }
+    };
+
+    /**
+     * MIPS: like RISC-V, with `$` registers.
+     */
+    struct Mips {
+        static constexpr bool RISC = true;
+        static constexpr size_t REGISTER_WIDTH = registers::mips::NAME_WIDTH;
+        static constexpr size_t MNEMONIC_WIDTH = detail::nameWidth(opcodes::mips::MNEMONICS);
+
+        [[nodiscard]] static constexpr auto opcode(std::string_view name) -> opcodes::Id { return opcodes::mips::lookup(name); }
+        [[nodiscard]] static constexpr auto reg(std::string_view name) -> const registers::Register* { return registers::mips::lookup(name); }
+        [[nodiscard]] static constexpr auto immediate(std::string_view operand) -> bool { return detail::isNumber(operand); }
+        [[nodiscard]] static auto memory(std::string_view operand) -> bool { return detail::isBaseOffset<Mips>(operand); }
+        [[nodiscard]] static constexpr auto comment(std::string_view line) -> size_t { return detail::findComment(line, "#", false); }
+    };
+
+    /**
+     * Calls `fn` with the backend of an architecture.
+     */
+    template <typename Fn>
+    constexpr auto dispatch(arch::Isa architecture, Fn&& fn) -> decltype(auto) {
+        switch (architecture) {
+        case arch::ARM: return fn(Arm{});
+        case arch::RISCV: return fn(RiscV{});
+        case arch::MIPS: return fn(Mips{});
+        default: return fn(X86{});
+        }
+    }
+
+    /**
+     * The length of the longest register name of any backend.
+     */
+    inline constexpr size_t REGISTER_WIDTH = std::max({X86::REGISTER_WIDTH, Arm::REGISTER_WIDTH, RiscV::REGISTER_WIDTH, Mips::REGISTER_WIDTH});
+
+    /**
+     * @param name The register name to look up (lowercase).
+     * @return The register of that name in the backend of `architecture`, or nullptr.
+     */
+    [[nodiscard]] inline auto lookupRegister(arch::Isa architecture, std::string_view name) -> const registers::Register* {
+        return dispatch(architecture, [name](auto backend) { return decltype(backend)::reg(name); });
+    }
+
+    static_assert(Arm::immediate("#4") && Arm::memory("[sp, #8]") && !Arm::immediate("r0"));
+    static_assert(RiscV::immediate("-16") && !RiscV::immediate("a0") && RiscV::comment("\tli a0, 1 # one") == 10);
+    static_assert(Arm::comment("\t.ascii \"@\" @ at") == 12 && Arm::comment("\tret // done") == 5);
+} // namespace isa
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <analysis.hpp>
+#include <hash.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * A namespace for the memo of analyzed lines.
+ *
+ * Compiler output repeats the same lines (`push %rbp`, `ret`, `nop`...) hundreds of
+ * thousands of times, and the comment of a line only depends on its text and on the
+ * backend it is analyzed with. A Cache remembers the comments of recent lines so that
+ * a repeated line is copied instead of parsed and formatted again.
+ *
+ * The cache is a fixed array of slots: its memory never grows, whatever the input.
+ * Each line maps to one slot by its hash; a slot that was hit since it was filled
+ * gets a second chance before a new line replaces it (CLOCK on one slot), so hot
+ * lines survive runs of one-off ones. Lines and comments too long for a slot are
+ * never cached, and neither are labels, which are unique.
+ *
+ * A Cache is not synchronized: every thread keeps its own, one per backend.
+ */
+namespace memo {
+    /**
+     * The longest line a slot holds (as written, indentation included).
+     */
+    inline constexpr size_t KEY_WIDTH = 64;
+
+    /**
+     * The longest comment a slot holds.
+     */
+    inline constexpr size_t VALUE_WIDTH = 128;
+
+    /**
+     * The slots of a cache (~200 bytes each).
+     */
+    inline constexpr size_t DEFAULT_SLOTS = 4096;
+
+    /**
+     * A remembered line.
+     */
+    struct Entry {
+        uint64_t hash = 0;
+        uint8_t keySize = 0;
+        uint8_t valueSize = 0;
+        bool referenced = false;
+        analysis::Kind kind = analysis::BLANK; // what stats::count() needs of the record
+        opcodes::Id opcode = opcodes::NONE;
+        directives::Id directive = directives::NONE;
+        char key[KEY_WIDTH];
+        char value[VALUE_WIDTH];
+
+        [[nodiscard]] auto comment() const -> std::string_view { return {value, valueSize}; }
+
+        /**
+         * @return The record, without its views into the line.
+         */
+        [[nodiscard]] auto record() const -> analysis::Record {
+            analysis::Record record;
+            record.kind = kind;
+            record.opcode = opcode;
+            record.directive = directive;
+            return record;
+        }
+    };
+
+    class Cache {
+    public:
+        /**
+         * @param slots The capacity, rounded up to a power of two.
+         */
+        explicit Cache(size_t slots = DEFAULT_SLOTS) : slots_(std::bit_ceil(std::max<size_t>(slots, 1))) {}
+
+        /**
+         * @return Whether `line` can be cached at all; only then are find() and insert() called.
+         */
+        [[nodiscard]] static auto cacheable(std::string_view line) -> bool { return !line.empty() && line.size() <= KEY_WIDTH; }
+
+        /**
+         * @param line A cacheable line.
+         * @param h The hash of `line`.
+         * @return The entry of `line`, or nullptr.
+         */
+        [[nodiscard]] auto find(std::string_view line, uint64_t h) -> const Entry* {
+            Entry& entry = slots_[h & (slots_.size() - 1)];
+            if (entry.keySize != 0 && entry.hash == h && entry.keySize == line.size() && std::memcmp(entry.key, line.data(), line.size()) == 0) {
+                entry.referenced = true;
+                ++hits_;
+                return &entry;
+            }
+            ++misses_;
+            return nullptr;
+        }
+
+        /**
+         * Remembers the comment of a line find() missed.
+         */
+        void insert(std::string_view line, uint64_t h, const analysis::Record& record, std::string_view comment) {
+            if (record.kind == analysis::LABEL || comment.size() > VALUE_WIDTH) return;
+            Entry& entry = slots_[h & (slots_.size() - 1)];
+            if (entry.referenced) {
+                entry.referenced = false;
+                return;
+            }
+            entry.hash = h;
+            entry.keySize = static_cast<uint8_t>(line.size());
+            entry.valueSize = static_cast<uint8_t>(comment.size());
+            entry.kind = record.kind;
+            entry.opcode = record.opcode;
+            entry.directive = record.directive;
+            std::memcpy(entry.key, line.data(), line.size());
+            std::memcpy(entry.value, comment.data(), comment.size());
+        }
+
+        [[nodiscard]] auto hits() const -> uint64_t { return hits_; }
+
+        [[nodiscard]] auto misses() const -> uint64_t { return misses_; }
+
+        /**
+         * Zeroes hits() and misses(); the entries stay.
+         */
+        void resetCounts() {
+            hits_ = 0;
+            misses_ = 0;
+        }
+
+    private:
+        std::vector<Entry> slots_;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+    };
+
+    static_assert(KEY_WIDTH <= UINT8_MAX && VALUE_WIDTH <= UINT8_MAX);
+} // namespace memo
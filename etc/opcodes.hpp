@@ -0,0 +1,159 @@
+#pragma once
+
+#include <phash.hpp>
+
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+/**
+ * A namespace for the recognized instruction mnemonics.
+ *
+ * An Id is what an instruction does; every backend (see isa.hpp) has its own
+ * mnemonics for it: the x86 ones at the top level, the others in a nested
+ * namespace per architecture.
+ */
+namespace opcodes {
+    /**
+     * Enumerates the recognized mnemonics.
+     */
+    enum Id : uint8_t {
+        INT, PUSH, POP, MOV, MOVQ, ADD, ADDQ, SUB, SUBQ,
+        JMP, CALL, RET, CMP, JE, JNE, INC, DEC, MUL, DIV,
+        GLOBAL, LEN, NOP,
+        /**
+         * Loads and stores of the load/store architectures.
+         */
+        LOAD, STORE,
+        /**
+         * Not a recognized instruction.
+         */
+        NONE
+    };
+
+    /**
+     * A mnemonic and its ID.
+     */
+    struct Mnemonic {
+        std::string_view name;
+        Id id = NONE;
+    };
+
+    /**
+     * The single list of recognized instructions; the lookup table is generated from it.
+     */
+    inline constexpr std::array MNEMONICS = {
+        Mnemonic{"int", INT}, Mnemonic{"push", PUSH}, Mnemonic{"pop", POP}, Mnemonic{"mov", MOV},
+        Mnemonic{"movq", MOVQ}, Mnemonic{"add", ADD}, Mnemonic{"addq", ADDQ}, Mnemonic{"sub", SUB},
+        Mnemonic{"subq", SUBQ}, Mnemonic{"jmp", JMP}, Mnemonic{"call", CALL}, Mnemonic{"ret", RET},
+        Mnemonic{"cmp", CMP}, Mnemonic{"je", JE}, Mnemonic{"jne", JNE}, Mnemonic{"inc", INC},
+        Mnemonic{"dec", DEC}, Mnemonic{"mul", MUL}, Mnemonic{"div", DIV}, Mnemonic{"global", GLOBAL},
+        Mnemonic{"len", LEN}, Mnemonic{"nop", NOP}
+    };
+
+    inline constexpr phash::Table TABLE {MNEMONICS};
+
+    /**
+     * A name for every Id, for reports: the x86 mnemonic, or the operation.
+     */
+    inline constexpr std::array OPERATIONS = [] {
+        std::array<Mnemonic, MNEMONICS.size() + 2> operations {};
+        for (size_t i = 0; i < MNEMONICS.size(); ++i) operations[i] = MNEMONICS[i];
+        operations[MNEMONICS.size()] = {"load", LOAD};
+        operations[MNEMONICS.size() + 1] = {"store", STORE};
+        return operations;
+    }();
+
+    /**
+     * @param name The mnemonic to look up (case-sensitive).
+     * @return Its ID, or NONE.
+     */
+    [[nodiscard]] constexpr auto lookup(std::string_view name) -> Id {
+        const Mnemonic* mnemonic = TABLE.find(name);
+        return mnemonic == nullptr ? NONE : mnemonic->id;
+    }
+
+    static_assert([] {
+        for (const Mnemonic& mnemonic : MNEMONICS) {
+            if (lookup(mnemonic.name) != mnemonic.id) return false;
+        }
+        return lookup("") == NONE && lookup("movl") == NONE && lookup("MOV") == NONE;
+    }());
+
+    /**
+     * ARM (AArch32 and AArch64, unconditional forms).
+     */
+    namespace arm {
+        inline constexpr std::array MNEMONICS = {
+            Mnemonic{"mov", MOV}, Mnemonic{"movs", MOV}, Mnemonic{"movw", MOV}, Mnemonic{"add", ADD},
+            Mnemonic{"adds", ADD}, Mnemonic{"sub", SUB}, Mnemonic{"subs", SUB}, Mnemonic{"b", JMP}, Mnemonic{"bx", JMP},
+            Mnemonic{"br", JMP}, Mnemonic{"bl", CALL}, Mnemonic{"blx", CALL}, Mnemonic{"blr", CALL},
+            Mnemonic{"ret", RET}, Mnemonic{"cmp", CMP}, Mnemonic{"beq", JE}, Mnemonic{"b.eq", JE}, Mnemonic{"bne", JNE},
+            Mnemonic{"b.ne", JNE}, Mnemonic{"cbz", JE}, Mnemonic{"cbnz", JNE}, Mnemonic{"push", PUSH},
+            Mnemonic{"pop", POP}, Mnemonic{"mul", MUL}, Mnemonic{"sdiv", DIV}, Mnemonic{"udiv", DIV},
+            Mnemonic{"nop", NOP}, Mnemonic{"svc", INT}, Mnemonic{"swi", INT}, Mnemonic{"ldr", LOAD},
+            Mnemonic{"ldrb", LOAD}, Mnemonic{"ldrh", LOAD}, Mnemonic{"ldrsb", LOAD}, Mnemonic{"ldrsh", LOAD},
+            Mnemonic{"ldrsw", LOAD}, Mnemonic{"str", STORE}, Mnemonic{"strb", STORE}, Mnemonic{"strh", STORE}
+        };
+
+        inline constexpr phash::Table TABLE {MNEMONICS};
+
+        [[nodiscard]] constexpr auto lookup(std::string_view name) -> Id {
+            const Mnemonic* mnemonic = TABLE.find(name);
+            return mnemonic == nullptr ? NONE : mnemonic->id;
+        }
+
+        static_assert(lookup("bl") == CALL && lookup("b.ne") == JNE && lookup("ldrsb") == LOAD && lookup("jmp") == NONE);
+    } // namespace arm
+
+    /**
+     * RISC-V, with the common pseudo-instructions.
+     */
+    namespace riscv {
+        inline constexpr std::array MNEMONICS = {
+            Mnemonic{"mv", MOV}, Mnemonic{"li", MOV}, Mnemonic{"la", MOV}, Mnemonic{"add", ADD}, Mnemonic{"addi", ADD},
+            Mnemonic{"addw", ADD}, Mnemonic{"addiw", ADD}, Mnemonic{"sub", SUB}, Mnemonic{"subw", SUB}, Mnemonic{"j", JMP},
+            Mnemonic{"jr", JMP}, Mnemonic{"tail", JMP}, Mnemonic{"jal", CALL}, Mnemonic{"jalr", CALL}, Mnemonic{"call", CALL},
+            Mnemonic{"ret", RET}, Mnemonic{"beq", JE}, Mnemonic{"beqz", JE}, Mnemonic{"bne", JNE}, Mnemonic{"bnez", JNE},
+            Mnemonic{"mul", MUL}, Mnemonic{"mulw", MUL}, Mnemonic{"div", DIV}, Mnemonic{"divu", DIV}, Mnemonic{"divw", DIV},
+            Mnemonic{"divuw", DIV}, Mnemonic{"nop", NOP}, Mnemonic{"ecall", INT}, Mnemonic{"lb", LOAD}, Mnemonic{"lbu", LOAD},
+            Mnemonic{"lh", LOAD}, Mnemonic{"lhu", LOAD}, Mnemonic{"lw", LOAD}, Mnemonic{"lwu", LOAD}, Mnemonic{"ld", LOAD},
+            Mnemonic{"flw", LOAD}, Mnemonic{"fld", LOAD}, Mnemonic{"sb", STORE}, Mnemonic{"sh", STORE}, Mnemonic{"sw", STORE},
+            Mnemonic{"sd", STORE}, Mnemonic{"fsw", STORE}, Mnemonic{"fsd", STORE}
+        };
+
+        inline constexpr phash::Table TABLE {MNEMONICS};
+
+        [[nodiscard]] constexpr auto lookup(std::string_view name) -> Id {
+            const Mnemonic* mnemonic = TABLE.find(name);
+            return mnemonic == nullptr ? NONE : mnemonic->id;
+        }
+
+        static_assert(lookup("addi") == ADD && lookup("bnez") == JNE && lookup("sd") == STORE && lookup("mov") == NONE);
+    } // namespace riscv
+
+    /**
+     * MIPS, with the common pseudo-instructions.
+     */
+    namespace mips {
+        inline constexpr std::array MNEMONICS = {
+            Mnemonic{"move", MOV}, Mnemonic{"li", MOV}, Mnemonic{"la", MOV}, Mnemonic{"add", ADD}, Mnemonic{"addu", ADD},
+            Mnemonic{"addi", ADD}, Mnemonic{"addiu", ADD}, Mnemonic{"sub", SUB}, Mnemonic{"subu", SUB}, Mnemonic{"j", JMP},
+            Mnemonic{"b", JMP}, Mnemonic{"jr", JMP}, Mnemonic{"jal", CALL}, Mnemonic{"jalr", CALL}, Mnemonic{"bal", CALL},
+            Mnemonic{"beq", JE}, Mnemonic{"beqz", JE}, Mnemonic{"bne", JNE}, Mnemonic{"bnez", JNE}, Mnemonic{"mul", MUL},
+            Mnemonic{"mult", MUL}, Mnemonic{"multu", MUL}, Mnemonic{"div", DIV}, Mnemonic{"divu", DIV}, Mnemonic{"nop", NOP},
+            Mnemonic{"syscall", INT}, Mnemonic{"lb", LOAD}, Mnemonic{"lbu", LOAD}, Mnemonic{"lh", LOAD}, Mnemonic{"lhu", LOAD},
+            Mnemonic{"lw", LOAD}, Mnemonic{"ld", LOAD}, Mnemonic{"lwc1", LOAD}, Mnemonic{"ldc1", LOAD}, Mnemonic{"sb", STORE},
+            Mnemonic{"sh", STORE}, Mnemonic{"sw", STORE}, Mnemonic{"sd", STORE}, Mnemonic{"swc1", STORE}, Mnemonic{"sdc1", STORE}
+        };
+
+        inline constexpr phash::Table TABLE {MNEMONICS};
+
+        [[nodiscard]] constexpr auto lookup(std::string_view name) -> Id {
+            const Mnemonic* mnemonic = TABLE.find(name);
+            return mnemonic == nullptr ? NONE : mnemonic->id;
+        }
+
+        static_assert(lookup("addiu") == ADD && lookup("jal") == CALL && lookup("swc1") == STORE && lookup("mv") == NONE);
+    } // namespace mips
+} // namespace opcodes
@@ -0,0 +1,441 @@
+#pragma once
+
+#include <condition_variable>
+#include <algorithm>
+#include <string_view>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mutex>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <climits>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ASM_ANALYZE_IO_URING 1
+#endif
+#endif
+
+/**
+ * A namespace for input/output helpers.
+ */
+namespace io {
+#if defined(ASM_ANALYZE_IO_URING)
+    /**
+     * A minimal single-entry io_uring used to submit vectored writes.
+     */
+    class Ring {
+    public:
+        Ring() = default;
+        Ring(const Ring&) = delete;
+        auto operator=(const Ring&) -> Ring& = delete;
+        Ring(Ring&&) = delete;
+        auto operator=(Ring&&) -> Ring& = delete;
+
+        ~Ring() {
+            if (sqes_ != nullptr) ::munmap(sqes_, sqesSize_);
+            if (cqRing_ != nullptr && cqRing_ != sqRing_) ::munmap(cqRing_, cqSize_);
+            if (sqRing_ != nullptr) ::munmap(sqRing_, sqSize_);
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        /**
+         * Sets up the ring.
+         *
+         * @return False when io_uring is unavailable (old kernel, seccomp, ...).
+         */
+        [[nodiscard]] auto init() -> bool {
+            io_uring_params params {};
+            fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, 4, &params));
+            if (fd_ < 0) return false;
+
+            sqSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+
+            sqRing_ = map(sqSize_, IORING_OFF_SQ_RING);
+            if (sqRing_ == nullptr) return false;
+            cqRing_ = single ? sqRing_ : map(cqSize_, IORING_OFF_CQ_RING);
+            if (cqRing_ == nullptr) return false;
+            sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(map(sqesSize_, IORING_OFF_SQES));
+            if (sqes_ == nullptr) return false;
+
+            auto* sq = static_cast<char*>(sqRing_);
+            auto* cq = static_cast<char*>(cqRing_);
+            sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        /**
+         * Writes the given buffers at the given file offset and waits for completion.
+         *
+         * @return The number of bytes written, or -errno.
+         */
+        auto writev(int fd, const iovec* iov, unsigned count, uint64_t offset) -> long {
+            unsigned tail = *sqTail_;
+            unsigned index = tail & sqMask_;
+            io_uring_sqe& sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_WRITEV;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<uint64_t>(iov);
+            sqe.len = count;
+            sqe.off = offset;
+            sqArray_[index] = index;
+            __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+            unsigned head = *cqHead_;
+            unsigned toSubmit = 1;
+            while (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                long entered = ::syscall(__NR_io_uring_enter, fd_, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (entered < 0 && errno != EINTR) return -errno;
+                if (entered > 0) toSubmit = 0;
+            }
+
+            long result = cqes_[head & cqMask_].res;
+            __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+            return result;
+        }
+
+    private:
+        auto map(size_t size, off_t offset) const -> void* {
+            void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+            return addr == MAP_FAILED ? nullptr : addr;
+        }
+
+        int fd_ = -1;
+        void* sqRing_ = nullptr;
+        void* cqRing_ = nullptr;
+        size_t sqSize_ = 0;
+        size_t cqSize_ = 0;
+        size_t sqesSize_ = 0;
+        io_uring_sqe* sqes_ = nullptr;
+        io_uring_cqe* cqes_ = nullptr;
+        unsigned* sqTail_ = nullptr;
+        unsigned* sqArray_ = nullptr;
+        unsigned* cqHead_ = nullptr;
+        unsigned* cqTail_ = nullptr;
+        unsigned sqMask_ = 0;
+        unsigned cqMask_ = 0;
+    };
+#endif
+
+    /**
+     * A double-buffered output file.
+     *
+     * Small writes are gathered in a staging buffer, large blocks are taken over
+     * without copying. Once a batch is big enough it is handed to a writer thread,
+     * which flushes it with a single vectored write (io_uring on Linux for the
+     * files it opens itself, writev otherwise) while the caller fills the next batch.
+     */
+    class OutputFile {
+    public:
+        /**
+         * Opens (creates or truncates) the given file.
+         *
+         * @param path The path of the file to write, or "-" for stdout.
+         */
+        explicit OutputFile(const std::string& path) {
+#if !defined(_WIN32) && !defined(_WIN64)
+            if (path == "-") {
+                std::cout.flush();
+                fd_ = STDOUT_FILENO;
+                owned_ = false;
+            } else {
+                fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+                if (fd_ < 0) return;
+            }
+
+#if defined(ASM_ANALYZE_IO_URING)
+            // io_uring writes at offsets counted from 0, which only holds for a file truncated
+            // here: a redirected stdout may already be written to or opened for appending
+            struct stat st {};
+            bool regular = ::fstat(fd_, &st) == 0 && S_ISREG(st.st_mode);
+            if (owned_ && regular && ring_.init()) backend_ = "io_uring";
+#endif
+#else
+            if (path == "-") {
+                stream_ = &std::cout;
+            } else {
+                file_.open(path, std::ios::binary);
+                if (!file_) return;
+                stream_ = &file_;
+            }
+            backend_ = "stream";
+#endif
+            good_ = true;
+            writer_ = std::thread([this] { run(); });
+        }
+
+#if !defined(_WIN32) && !defined(_WIN64)
+        /**
+         * Writes to an open descriptor (a pipe or a socket), which stays open.
+         *
+         * @param fd The descriptor to write to.
+         */
+        explicit OutputFile(int fd) : fd_(fd), owned_(false) {
+            good_ = fd_ >= 0;
+            if (good_) writer_ = std::thread([this] { run(); });
+        }
+#endif
+
+        /**
+         * Writes into a string instead of a file (for in-memory analysis), without a writer thread.
+         *
+         * @param target Receives the output; it must outlive the OutputFile.
+         */
+        explicit OutputFile(std::string* target) {
+            memory_ = target;
+            backend_ = "memory";
+            good_ = true;
+        }
+
+        OutputFile(const OutputFile&) = delete;
+        auto operator=(const OutputFile&) -> OutputFile& = delete;
+        OutputFile(OutputFile&&) = delete;
+        auto operator=(OutputFile&&) -> OutputFile& = delete;
+
+        ~OutputFile() {
+            try {
+                close();
+            } catch (...) { // NOLINT(bugprone-empty-catch): errors are reported by an explicit close()
+            }
+        }
+
+        /**
+         * @return Whether the file was opened successfully.
+         */
+        [[nodiscard]] explicit operator bool() const { return good_; }
+
+        /**
+         * @return The name of the write backend in use.
+         */
+        [[nodiscard]] auto backend() const -> std::string_view { return backend_; }
+
+        /**
+         * @return The number of bytes written so far (including the buffered ones).
+         */
+        [[nodiscard]] auto position() const -> uint64_t { return position_; }
+
+        /**
+         * Appends text, copying it into the staging buffer.
+         */
+        void write(std::string_view text) {
+            if (text.empty()) return;
+            if (text.size() >= STAGING_SIZE) {
+                write(std::string(text));
+                return;
+            }
+
+            if (staging_.size() + text.size() > STAGING_SIZE) stage();
+            if (staging_.capacity() < STAGING_SIZE) staging_.reserve(STAGING_SIZE);
+            staging_ += text;
+            position_ += text.size();
+        }
+
+        /**
+         * Appends a block, taking it over without copying.
+         */
+        void write(std::string&& block) {
+            if (block.empty()) return;
+            if (block.size() < STAGING_SIZE / 4) {
+                write(std::string_view(block));
+                return;
+            }
+
+            stage();
+            position_ += block.size();
+            batchSize_ += block.size();
+            batch_.push_back(std::move(block));
+            if (batchSize_ >= BATCH_SIZE) flush();
+        }
+
+        /**
+         * Hands everything written so far to the writer thread, waiting only for the
+         * previous batch to finish.
+         *
+         * @throws std::runtime_error if an earlier write failed.
+         */
+        void flush() {
+            stage();
+            if (batch_.empty()) return;
+            if (memory_ != nullptr) {
+                for (std::string& block : batch_) {
+                    if (memory_->empty()) *memory_ = std::move(block);
+                    else *memory_ += block;
+                }
+                batch_.clear();
+                batchSize_ = 0;
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return inFlight_.empty(); });
+            if (!error_.empty()) throw std::runtime_error(error_);
+            inFlight_.swap(batch_);
+            batchSize_ = 0;
+            lock.unlock();
+            work_.notify_one();
+        }
+
+        /**
+         * Writes everything out and closes the file.
+         *
+         * @throws std::runtime_error if a write failed.
+         */
+        void close() {
+            if (memory_ != nullptr) flush();
+            if (!writer_.joinable()) return;
+
+            std::string error;
+            try {
+                flush();
+                wait();
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                if (error.empty()) error = error_;
+            }
+            work_.notify_one();
+            writer_.join();
+
+#if !defined(_WIN32) && !defined(_WIN64)
+            if (owned_ && ::close(fd_) != 0 && error.empty()) error = std::strerror(errno);
+#else
+            if (stream_ == &file_) file_.close();
+            else stream_->flush();
+#endif
+            if (!error.empty()) throw std::runtime_error("Write failed: " + error);
+        }
+
+    private:
+        static constexpr size_t STAGING_SIZE = static_cast<size_t>(1) << 20;
+        static constexpr size_t BATCH_SIZE = static_cast<size_t>(8) << 20;
+
+        void stage() {
+            if (staging_.empty()) return;
+            batchSize_ += staging_.size();
+            batch_.push_back(std::move(staging_));
+            staging_ = std::string();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return inFlight_.empty(); });
+            if (!error_.empty()) throw std::runtime_error(error_);
+        }
+
+        void run() {
+            for (;;) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_.wait(lock, [this] { return stopping_ || !inFlight_.empty(); });
+                if (inFlight_.empty()) return;
+                lock.unlock();
+
+                // the producer does not touch inFlight_ until it is empty again
+                std::string error = error_.empty() ? writeBatch(inFlight_) : std::string();
+
+                lock.lock();
+                if (error_.empty()) error_ = error;
+                inFlight_.clear();
+                lock.unlock();
+                idle_.notify_all();
+            }
+        }
+
+        auto writeBatch(const std::vector<std::string>& blocks) -> std::string {
+#if !defined(_WIN32) && !defined(_WIN64)
+            std::vector<iovec> iov;
+            iov.reserve(blocks.size());
+            for (const std::string& block : blocks) {
+                iov.push_back({const_cast<char*>(block.data()), block.size()});
+            }
+
+            size_t first = 0;
+            while (first < iov.size()) {
+                auto count = static_cast<unsigned>(std::min<size_t>(iov.size() - first, IOV_MAX));
+                long written = 0;
+#if defined(ASM_ANALYZE_IO_URING)
+                if (backend_ == "io_uring") {
+                    written = ring_.writev(fd_, &iov[first], count, fileOffset_);
+                    if (written < 0) return std::strerror(static_cast<int>(-written));
+                } else
+#endif
+                {
+                    written = ::writev(fd_, &iov[first], static_cast<int>(count));
+                    if (written < 0) {
+                        if (errno == EINTR) continue;
+                        return std::strerror(errno);
+                    }
+                }
+                if (written == 0) return "no progress";
+                fileOffset_ += static_cast<uint64_t>(written);
+
+                // skip the fully written buffers and trim a partially written one
+                auto remaining = static_cast<size_t>(written);
+                while (first < iov.size() && remaining >= iov[first].iov_len) remaining -= iov[first++].iov_len;
+                if (remaining > 0) {
+                    iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+                    iov[first].iov_len -= remaining;
+                }
+            }
+#else
+            for (const std::string& block : blocks) stream_->write(block.data(), static_cast<std::streamsize>(block.size()));
+            if (!*stream_) return "stream error";
+#endif
+            return {};
+        }
+
+#if !defined(_WIN32) && !defined(_WIN64)
+        int fd_ = -1;
+        bool owned_ = true;
+#if defined(ASM_ANALYZE_IO_URING)
+        Ring ring_;
+#endif
+#else
+        std::ofstream file_;
+        std::ostream* stream_ = nullptr;
+#endif
+        std::string* memory_ = nullptr;
+        std::string_view backend_ = "writev";
+        bool good_ = false;
+        uint64_t position_ = 0;
+        uint64_t fileOffset_ = 0; // writer thread only
+
+        std::string staging_;
+        std::vector<std::string> batch_;
+        size_t batchSize_ = 0;
+
+        std::vector<std::string> inFlight_;
+        std::string error_;
+        bool stopping_ = false;
+        std::mutex mutex_;
+        std::condition_variable work_;
+        std::condition_variable idle_;
+        std::thread writer_;
+    };
+} // namespace io
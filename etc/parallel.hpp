@@ -0,0 +1,240 @@
+#pragma once
+
+#include <condition_variable>
+#include <string_view>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <memory>
+#include <future>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+/**
+ * A namespace for multi-threading helpers.
+ */
+namespace parallel {
+    /**
+     * @return The default number of worker threads (hardware concurrency, at least 1).
+     */
+    [[nodiscard]] inline auto defaultJobs() -> unsigned {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    /**
+     * A fixed-size pool of worker threads consuming a FIFO task queue.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * Starts the worker threads.
+         *
+         * @param threads Number of worker threads (at least 1).
+         */
+        explicit ThreadPool(unsigned threads) {
+            if (threads == 0) threads = 1;
+            workers_.reserve(threads);
+            for (unsigned i = 0; i < threads; ++i) {
+                workers_.emplace_back([this] { run(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+        /**
+         * Finishes the queued tasks and joins the worker threads.
+         */
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            for (std::thread& worker : workers_) worker.join();
+        }
+
+        /**
+         * @return The number of worker threads.
+         */
+        [[nodiscard]] auto size() const -> size_t { return workers_.size(); }
+
+        /**
+         * Queues a task for execution.
+         *
+         * @param fn The callable to run on a worker thread.
+         * @return A future holding the result (or the exception) of the task.
+         */
+        template <typename F>
+        [[nodiscard]] auto submit(F&& fn) -> std::future<std::invoke_result_t<F>> {
+            using R = std::invoke_result_t<F>;
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+            std::future<R> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.emplace_back([task] { (*task)(); });
+            }
+            cv_.notify_one();
+            return result;
+        }
+
+    private:
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                    if (tasks_.empty()) return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+    };
+
+    /**
+     * Splits text into chunks of roughly the given size, each ending right after a '\n'
+     * (except possibly the last one), so that no line straddles two chunks.
+     *
+     * @param text The text to split.
+     * @param chunkSize The target chunk size in bytes.
+     * @return The chunks, in order.
+     */
+    [[nodiscard]] inline auto splitLines(std::string_view text, size_t chunkSize) -> std::vector<std::string_view> {
+        std::vector<std::string_view> chunks;
+        if (chunkSize == 0) chunkSize = 1;
+
+        size_t begin = 0;
+        while (begin < text.size()) {
+            size_t end = begin + chunkSize;
+            if (end >= text.size()) {
+                end = text.size();
+            } else {
+                end = text.find('\n', end);
+                end = end == std::string_view::npos ? text.size() : end + 1;
+            }
+            chunks.push_back(text.substr(begin, end - begin));
+            begin = end;
+        }
+        return chunks;
+    }
+
+    /**
+     * Maps every chunk through `analyze` on the pool and hands the results to `write`
+     * in the original order. At most `window` chunks are in flight at a time, which
+     * bounds the memory held by finished-but-unwritten results.
+     *
+     * @param pool The pool to run on (nullptr runs everything on the calling thread).
+     * @param chunks The inputs, in order.
+     * @param analyze Callable mapping a chunk to its result.
+     * @param write Callable consuming the results in order.
+     * @param window Maximum number of chunks in flight.
+     */
+    template <typename T, typename Analyze, typename Write>
+    inline void orderedMap(ThreadPool* pool, const std::vector<T>& chunks, Analyze analyze, Write write, size_t window) {
+        if (pool == nullptr) {
+            for (const T& chunk : chunks) write(analyze(chunk));
+            return;
+        }
+
+        using R = std::invoke_result_t<Analyze&, const T&>;
+        std::deque<std::future<R>> pending;
+        if (window == 0) window = 1;
+
+        try {
+            for (const T& chunk : chunks) {
+                pending.push_back(pool->submit([&analyze, &chunk] { return analyze(chunk); }));
+                if (pending.size() >= window) {
+                    write(pending.front().get());
+                    pending.pop_front();
+                }
+            }
+            while (!pending.empty()) {
+                write(pending.front().get());
+                pending.pop_front();
+            }
+        } catch (...) {
+            // the queued tasks still reference `analyze` and the chunks
+            for (std::future<R>& result : pending) {
+                if (result.valid()) result.wait();
+            }
+            throw;
+        }
+    }
+
+    /**
+     * Runs `fn` on every item with a set of work-stealing workers.
+     *
+     * Items are dealt round-robin, in the given order, to per-worker deques. A worker
+     * takes the front of its own deque and, once that is empty, steals the front of
+     * another worker's deque. Passing the items largest-first therefore starts the
+     * longest jobs first on every worker and leaves the short ones to fill the tail.
+     *
+     * @param items The work items, in the preferred start order.
+     * @param threads Number of workers (1 runs everything on the calling thread).
+     * @param fn Callable consuming one item; the first exception thrown is rethrown
+     *           once all workers have stopped.
+     */
+    template <typename T, typename Fn>
+    inline void stealingForEach(const std::vector<T>& items, unsigned threads, Fn fn) {
+        size_t workers = std::min<size_t>(threads == 0 ? 1 : threads, items.size());
+        if (workers <= 1) {
+            for (const T& item : items) fn(item);
+            return;
+        }
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<const T*> items;
+        };
+        std::vector<Queue> queues(workers);
+        for (size_t i = 0; i < items.size(); ++i) queues[i % workers].items.push_back(&items[i]);
+
+        auto take = [&queues, workers](size_t self) -> const T* {
+            for (size_t i = 0; i < workers; ++i) {
+                Queue& queue = queues[(self + i) % workers];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.items.empty()) {
+                    const T* item = queue.items.front();
+                    queue.items.pop_front();
+                    return item;
+                }
+            }
+            return nullptr;
+        };
+
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto run = [&](size_t self) {
+            while (const T* item = take(self)) {
+                try {
+                    fn(*item);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (size_t i = 1; i < workers; ++i) pool.emplace_back(run, i);
+        run(0);
+        for (std::thread& worker : pool) worker.join();
+
+        if (error) std::rethrow_exception(error);
+    }
+} // namespace parallel
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <bit>
+
+/**
+ * A namespace for compile-time perfect hashing of string keys.
+ */
+namespace phash {
+    /**
+     * 64-bit FNV-1a of the key.
+     */
+    [[nodiscard]] constexpr auto hash(std::string_view key) -> uint64_t {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (char c : key) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 0x100000001B3ULL;
+        }
+        return h;
+    }
+
+    /**
+     * Rehashes a key hash under a per-bucket seed (murmur3 finalizer).
+     */
+    [[nodiscard]] constexpr auto mix(uint64_t h, uint64_t seed) -> uint64_t {
+        h ^= seed * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /**
+     * A static map from string keys to entries, built at compile time with
+     * hash-and-displace: keys are grouped into buckets by their hash, and every
+     * bucket gets a seed under which its keys land in free slots. A lookup is
+     * one hash, one seed load, one slot load and one key comparison.
+     *
+     * @tparam Entry An aggregate with a `std::string_view name` member.
+     * @tparam N The number of entries.
+     */
+    template <typename Entry, size_t N>
+    class Table {
+    public:
+        /**
+         * Builds the table. Fails to compile on duplicate names.
+         *
+         * @param entries The entries to index.
+         */
+        constexpr explicit Table(const std::array<Entry, N>& entries) : entries_(entries) {
+            std::array<uint64_t, N> hashes {};
+            std::array<size_t, BUCKETS + 1> start {};
+            std::array<uint16_t, N> order {};
+
+            // Counting sort of the entries by bucket
+            for (size_t i = 0; i < N; ++i) {
+                hashes[i] = hash(entries_[i].name);
+                ++start[hashes[i] % BUCKETS + 1];
+            }
+            for (size_t b = 0; b < BUCKETS; ++b) start[b + 1] += start[b];
+            std::array<size_t, BUCKETS> fill {};
+            for (size_t i = 0; i < N; ++i) {
+                size_t b = hashes[i] % BUCKETS;
+                order[start[b] + fill[b]++] = static_cast<uint16_t>(i);
+            }
+
+            // Place the largest buckets first, while the table is still empty
+            std::array<uint16_t, BUCKETS> buckets {};
+            for (size_t b = 0; b < BUCKETS; ++b) buckets[b] = static_cast<uint16_t>(b);
+            for (size_t i = 1; i < BUCKETS; ++i) {
+                for (size_t j = i; j > 0 && fill[buckets[j]] > fill[buckets[j - 1]]; --j) {
+                    uint16_t tmp = buckets[j];
+                    buckets[j] = buckets[j - 1];
+                    buckets[j - 1] = tmp;
+                }
+            }
+
+            for (uint16_t b : buckets) {
+                size_t count = fill[b];
+                if (count == 0) break;
+
+                for (uint64_t seed = 1;; ++seed) {
+                    if (seed > MAX_SEED) throw "phash::Table: no seed found (duplicate names?)";
+
+                    std::array<size_t, N> placed {};
+                    bool ok = true;
+                    for (size_t k = 0; k < count && ok; ++k) {
+                        size_t slot = mix(hashes[order[start[b] + k]], seed) & (SLOTS - 1);
+                        ok = slots_[slot] == 0;
+                        for (size_t p = 0; p < k && ok; ++p) ok = placed[p] != slot;
+                        placed[k] = slot;
+                    }
+                    if (!ok) continue;
+
+                    for (size_t k = 0; k < count; ++k) slots_[placed[k]] = static_cast<uint16_t>(order[start[b] + k] + 1);
+                    seeds_[b] = seed;
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @param key The name to look up.
+         * @return The entry with the given name, or nullptr.
+         */
+        [[nodiscard]] constexpr auto find(std::string_view key) const -> const Entry* {
+            uint64_t h = hash(key);
+            uint16_t index = slots_[mix(h, seeds_[h % BUCKETS]) & (SLOTS - 1)];
+            if (index == 0) return nullptr;
+
+            const Entry& entry = entries_[index - 1];
+            return entry.name == key ? &entry : nullptr;
+        }
+
+        /**
+         * @return All entries, in declaration order.
+         */
+        [[nodiscard]] constexpr auto entries() const -> const std::array<Entry, N>& { return entries_; }
+
+    private:
+        static_assert(N > 0 && N < 0xFFFF, "phash::Table supports 1 to 65534 entries");
+
+        static constexpr size_t BUCKETS = N / 2 + 1;
+        static constexpr size_t SLOTS = std::bit_ceil(N + N / 4 + 1);
+        static constexpr uint64_t MAX_SEED = static_cast<uint64_t>(1) << 16;
+
+        std::array<Entry, N> entries_;
+        std::array<uint64_t, BUCKETS> seeds_ {};
+        std::array<uint16_t, SLOTS> slots_ {}; // entry index + 1, 0 marks an empty slot
+    };
+} // namespace phash
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <phash.hpp>
+
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+/**
+ * A namespace for the recognized registers: the x86 ones at the top level, and those of
+ * the other backends (see isa.hpp) in a nested namespace per architecture.
+ */
+namespace registers {
+    /**
+     * Enumerates the register classes.
+     */
+    enum Class : uint8_t {
+        GPR,
+        POINTER,
+        FLAGS,
+        X87,
+        MMX,
+        XMM,
+        YMM,
+        ZMM,
+        CONTROL,
+        DEBUG,
+        TEST,
+        /**
+         * Descriptor table registers and the machine status word.
+         */
+        SYSTEM,
+        MSR,
+        FLOAT,
+        VECTOR
+    };
+
+    /**
+     * Display names, indexed by Class.
+     */
+    inline constexpr std::array<std::string_view, VECTOR + 1> CLASS_NAMES = {
+        "general purpose", "instruction pointer", "flags", "x87", "MMX", "XMM", "YMM", "ZMM",
+        "control", "debug", "test", "system", "model-specific", "floating point", "vector"
+    };
+
+    /**
+     * @return The display name of the given register class.
+     */
+    [[nodiscard]] constexpr auto className(Class kind) -> std::string_view {
+        return CLASS_NAMES[kind];
+    }
+
+    /**
+     * A register name (lowercase) and its metadata.
+     */
+    struct Register {
+        std::string_view name;
+        Class kind = GPR;
+        uint16_t width = 0; // in bits
+    };
+
+    inline constexpr std::array REGISTERS = {
+        // General purpose
+        Register{"rax", GPR, 64}, Register{"rbx", GPR, 64}, Register{"rcx", GPR, 64}, Register{"rdx", GPR, 64}, Register{"rsi", GPR, 64},
+        Register{"rdi", GPR, 64}, Register{"rbp", GPR, 64}, Register{"rsp", GPR, 64}, Register{"r8", GPR, 64}, Register{"r9", GPR, 64},
+        Register{"r10", GPR, 64}, Register{"r11", GPR, 64}, Register{"r12", GPR, 64}, Register{"r13", GPR, 64}, Register{"r14", GPR, 64},
+        Register{"r15", GPR, 64}, Register{"eax", GPR, 32}, Register{"ebx", GPR, 32}, Register{"ecx", GPR, 32}, Register{"edx", GPR, 32},
+        Register{"esi", GPR, 32}, Register{"edi", GPR, 32}, Register{"ebp", GPR, 32}, Register{"esp", GPR, 32}, Register{"r8d", GPR, 32},
+        Register{"r9d", GPR, 32}, Register{"r10d", GPR, 32}, Register{"r11d", GPR, 32}, Register{"r12d", GPR, 32},
+        Register{"r13d", GPR, 32}, Register{"r14d", GPR, 32}, Register{"r15d", GPR, 32}, Register{"ax", GPR, 16}, Register{"bx", GPR, 16},
+        Register{"cx", GPR, 16}, Register{"dx", GPR, 16}, Register{"si", GPR, 16}, Register{"di", GPR, 16}, Register{"bp", GPR, 16},
+        Register{"sp", GPR, 16}, Register{"r8w", GPR, 16}, Register{"r9w", GPR, 16}, Register{"r10w", GPR, 16}, Register{"r11w", GPR, 16},
+        Register{"r12w", GPR, 16}, Register{"r13w", GPR, 16}, Register{"r14w", GPR, 16}, Register{"r15w", GPR, 16}, Register{"al", GPR, 8},
+        Register{"ah", GPR, 8}, Register{"bl", GPR, 8}, Register{"bh", GPR, 8}, Register{"cl", GPR, 8}, Register{"ch", GPR, 8},
+        Register{"dl", GPR, 8}, Register{"dh", GPR, 8}, Register{"sil", GPR, 8}, Register{"dil", GPR, 8}, Register{"bpl", GPR, 8},
+        Register{"spl", GPR, 8}, Register{"r8b", GPR, 8}, Register{"r9b", GPR, 8}, Register{"r10b", GPR, 8}, Register{"r11b", GPR, 8},
+        Register{"r12b", GPR, 8}, Register{"r13b", GPR, 8}, Register{"r14b", GPR, 8}, Register{"r15b", GPR, 8},
+        // Instruction pointer and flags
+        Register{"eip", POINTER, 32}, Register{"rip", POINTER, 64}, Register{"eflags", FLAGS, 32}, Register{"rflags", FLAGS, 64},
+        // x87 and SIMD
+        Register{"st0", X87, 80}, Register{"st1", X87, 80}, Register{"st2", X87, 80}, Register{"st3", X87, 80}, Register{"st4", X87, 80},
+        Register{"st5", X87, 80}, Register{"st6", X87, 80}, Register{"st7", X87, 80}, Register{"mm0", MMX, 64}, Register{"mm1", MMX, 64},
+        Register{"mm2", MMX, 64}, Register{"mm3", MMX, 64}, Register{"mm4", MMX, 64}, Register{"mm5", MMX, 64}, Register{"mm6", MMX, 64},
+        Register{"mm7", MMX, 64}, Register{"xmm0", XMM, 128}, Register{"xmm1", XMM, 128}, Register{"xmm2", XMM, 128},
+        Register{"xmm3", XMM, 128}, Register{"xmm4", XMM, 128}, Register{"xmm5", XMM, 128}, Register{"xmm6", XMM, 128},
+        Register{"xmm7", XMM, 128}, Register{"xmm8", XMM, 128}, Register{"xmm9", XMM, 128}, Register{"xmm10", XMM, 128},
+        Register{"xmm11", XMM, 128}, Register{"xmm12", XMM, 128}, Register{"xmm13", XMM, 128}, Register{"xmm14", XMM, 128},
+        Register{"xmm15", XMM, 128}, Register{"ymm0", YMM, 256}, Register{"ymm1", YMM, 256}, Register{"ymm2", YMM, 256},
+        Register{"ymm3", YMM, 256}, Register{"ymm4", YMM, 256}, Register{"ymm5", YMM, 256}, Register{"ymm6", YMM, 256},
+        Register{"ymm7", YMM, 256}, Register{"ymm8", YMM, 256}, Register{"ymm9", YMM, 256}, Register{"ymm10", YMM, 256},
+        Register{"ymm11", YMM, 256}, Register{"ymm12", YMM, 256}, Register{"ymm13", YMM, 256}, Register{"ymm14", YMM, 256},
+        Register{"ymm15", YMM, 256}, Register{"zmm0", ZMM, 512}, Register{"zmm1", ZMM, 512}, Register{"zmm2", ZMM, 512},
+        Register{"zmm3", ZMM, 512}, Register{"zmm4", ZMM, 512}, Register{"zmm5", ZMM, 512}, Register{"zmm6", ZMM, 512},
+        Register{"zmm7", ZMM, 512}, Register{"zmm8", ZMM, 512}, Register{"zmm9", ZMM, 512}, Register{"zmm10", ZMM, 512},
+        Register{"zmm11", ZMM, 512}, Register{"zmm12", ZMM, 512}, Register{"zmm13", ZMM, 512}, Register{"zmm14", ZMM, 512},
+        Register{"zmm15", ZMM, 512}, Register{"zmm16", ZMM, 512}, Register{"zmm17", ZMM, 512}, Register{"zmm18", ZMM, 512},
+        Register{"zmm19", ZMM, 512}, Register{"zmm20", ZMM, 512}, Register{"zmm21", ZMM, 512}, Register{"zmm22", ZMM, 512},
+        Register{"zmm23", ZMM, 512}, Register{"zmm24", ZMM, 512}, Register{"zmm25", ZMM, 512}, Register{"zmm26", ZMM, 512},
+        Register{"zmm27", ZMM, 512}, Register{"zmm28", ZMM, 512}, Register{"zmm29", ZMM, 512}, Register{"zmm30", ZMM, 512},
+        Register{"zmm31", ZMM, 512},
+        // Control, debug, test and descriptor table
+        Register{"cr0", CONTROL, 64}, Register{"cr1", CONTROL, 64}, Register{"cr2", CONTROL, 64}, Register{"cr3", CONTROL, 64},
+        Register{"cr4", CONTROL, 64}, Register{"dr0", DEBUG, 64}, Register{"dr1", DEBUG, 64}, Register{"dr2", DEBUG, 64},
+        Register{"dr3", DEBUG, 64}, Register{"dr6", DEBUG, 64}, Register{"dr7", DEBUG, 64}, Register{"tr3", TEST, 32},
+        Register{"tr4", TEST, 32}, Register{"tr5", TEST, 32}, Register{"tr6", TEST, 32}, Register{"tr7", TEST, 32},
+        Register{"gdtr", SYSTEM, 80}, Register{"idtr", SYSTEM, 80}, Register{"ldtr", SYSTEM, 16}, Register{"msw", SYSTEM, 16},
+        // Model-specific registers
+        Register{"msr_ia32_apic_base", MSR, 64}, Register{"msr_ia32_mtrrcap", MSR, 64}, Register{"msr_ia32_mtrr_physbase0", MSR, 64},
+        Register{"msr_ia32_mtrr_physbase1", MSR, 64}, Register{"msr_ia32_mtrr_physbase2", MSR, 64},
+        Register{"msr_ia32_mtrr_physbase3", MSR, 64}, Register{"msr_ia32_mtrr_physbase4", MSR, 64},
+        Register{"msr_ia32_mtrr_physbase5", MSR, 64}, Register{"msr_ia32_mtrr_physbase6", MSR, 64},
+        Register{"msr_ia32_mtrr_physbase7", MSR, 64}, Register{"msr_ia32_mtrr_physbase8", MSR, 64},
+        Register{"msr_ia32_mtrr_physbase9", MSR, 64}, Register{"msr_ia32_mtrr_physbase10", MSR, 64},
+        Register{"msr_ia32_mtrr_physmask0", MSR, 64}, Register{"msr_ia32_mtrr_physmask1", MSR, 64},
+        Register{"msr_ia32_mtrr_physmask2", MSR, 64}, Register{"msr_ia32_mtrr_physmask3", MSR, 64},
+        Register{"msr_ia32_mtrr_physmask4", MSR, 64}, Register{"msr_ia32_mtrr_physmask5", MSR, 64},
+        Register{"msr_ia32_mtrr_physmask7", MSR, 64}, Register{"msr_ia32_mtrr_physmask8", MSR, 64},
+        Register{"msr_ia32_mtrr_physmask9", MSR, 64}, Register{"msr_ia32_mtrr_physmask10", MSR, 64},
+        Register{"msr_ia32_perf_status", MSR, 64}, Register{"msr_ia32_perf_ctl", MSR, 64}, Register{"msr_ia32_time_stamp_counter", MSR, 64},
+        Register{"msr_ia32_feature_control", MSR, 64}, Register{"msr_ia32_sysenter_cs", MSR, 64},
+        Register{"msr_ia32_sysenter_esp", MSR, 64}, Register{"msr_ia32_sysenter_eip", MSR, 64}, Register{"msr_ia32_debugctl", MSR, 64},
+        Register{"msr_ia32_sgxleaf", MSR, 64}
+    };
+
+    inline constexpr phash::Table TABLE {REGISTERS};
+
+    /**
+     * @return The length of the longest name in `table`.
+     */
+    template <size_t N>
+    [[nodiscard]] constexpr auto nameWidth(const std::array<Register, N>& table) -> size_t {
+        size_t width = 0;
+        for (const Register& reg : table) width = reg.name.size() > width ? reg.name.size() : width;
+        return width;
+    }
+
+    /**
+     * The length of the longest register name.
+     */
+    inline constexpr size_t NAME_WIDTH = nameWidth(REGISTERS);
+
+    /**
+     * @param name The register name to look up (lowercase).
+     * @return The register's metadata, or nullptr if the name is not a register.
+     */
+    [[nodiscard]] constexpr auto lookup(std::string_view name) -> const Register* {
+        return TABLE.find(name);
+    }
+
+    static_assert(lookup("rax")->kind == GPR && lookup("rax")->width == 64);
+    static_assert(lookup("ah")->width == 8 && lookup("ymm15")->kind == YMM);
+    static_assert(lookup("msr_ia32_debugctl")->kind == MSR && lookup("RAX") == nullptr && lookup("dr4") == nullptr);
+
+    /**
+     * AArch32 and AArch64; the names they share take the AArch64 width.
+     */
+    namespace arm {
+        inline constexpr std::array REGISTERS = {
+            Register{"r0", GPR, 32}, Register{"r1", GPR, 32}, Register{"r2", GPR, 32}, Register{"r3", GPR, 32},
+            Register{"r4", GPR, 32}, Register{"r5", GPR, 32}, Register{"r6", GPR, 32}, Register{"r7", GPR, 32},
+            Register{"r8", GPR, 32}, Register{"r9", GPR, 32}, Register{"r10", GPR, 32}, Register{"r11", GPR, 32},
+            Register{"r12", GPR, 32}, Register{"r13", GPR, 32}, Register{"r14", GPR, 32}, Register{"r15", GPR, 32},
+            Register{"sb", GPR, 32}, Register{"sl", GPR, 32}, Register{"fp", GPR, 32}, Register{"ip", GPR, 32},
+            Register{"sp", GPR, 64}, Register{"lr", GPR, 64}, Register{"pc", POINTER, 32}, Register{"x0", GPR, 64},
+            Register{"x1", GPR, 64}, Register{"x2", GPR, 64}, Register{"x3", GPR, 64}, Register{"x4", GPR, 64},
+            Register{"x5", GPR, 64}, Register{"x6", GPR, 64}, Register{"x7", GPR, 64}, Register{"x8", GPR, 64},
+            Register{"x9", GPR, 64}, Register{"x10", GPR, 64}, Register{"x11", GPR, 64}, Register{"x12", GPR, 64},
+            Register{"x13", GPR, 64}, Register{"x14", GPR, 64}, Register{"x15", GPR, 64}, Register{"x16", GPR, 64},
+            Register{"x17", GPR, 64}, Register{"x18", GPR, 64}, Register{"x19", GPR, 64}, Register{"x20", GPR, 64},
+            Register{"x21", GPR, 64}, Register{"x22", GPR, 64}, Register{"x23", GPR, 64}, Register{"x24", GPR, 64},
+            Register{"x25", GPR, 64}, Register{"x26", GPR, 64}, Register{"x27", GPR, 64}, Register{"x28", GPR, 64},
+            Register{"x29", GPR, 64}, Register{"x30", GPR, 64}, Register{"xzr", GPR, 64}, Register{"w0", GPR, 32},
+            Register{"w1", GPR, 32}, Register{"w2", GPR, 32}, Register{"w3", GPR, 32}, Register{"w4", GPR, 32},
+            Register{"w5", GPR, 32}, Register{"w6", GPR, 32}, Register{"w7", GPR, 32}, Register{"w8", GPR, 32},
+            Register{"w9", GPR, 32}, Register{"w10", GPR, 32}, Register{"w11", GPR, 32}, Register{"w12", GPR, 32},
+            Register{"w13", GPR, 32}, Register{"w14", GPR, 32}, Register{"w15", GPR, 32}, Register{"w16", GPR, 32},
+            Register{"w17", GPR, 32}, Register{"w18", GPR, 32}, Register{"w19", GPR, 32}, Register{"w20", GPR, 32},
+            Register{"w21", GPR, 32}, Register{"w22", GPR, 32}, Register{"w23", GPR, 32}, Register{"w24", GPR, 32},
+            Register{"w25", GPR, 32}, Register{"w26", GPR, 32}, Register{"w27", GPR, 32}, Register{"w28", GPR, 32},
+            Register{"w29", GPR, 32}, Register{"w30", GPR, 32}, Register{"wzr", GPR, 32}, Register{"wsp", GPR, 32},
+            Register{"apsr", FLAGS, 32}, Register{"cpsr", FLAGS, 32}, Register{"spsr", FLAGS, 32}, Register{"fpscr", FLAGS, 32},
+            Register{"nzcv", FLAGS, 64}, Register{"s0", FLOAT, 32}, Register{"s1", FLOAT, 32}, Register{"s2", FLOAT, 32},
+            Register{"s3", FLOAT, 32}, Register{"s4", FLOAT, 32}, Register{"s5", FLOAT, 32}, Register{"s6", FLOAT, 32},
+            Register{"s7", FLOAT, 32}, Register{"s8", FLOAT, 32}, Register{"s9", FLOAT, 32}, Register{"s10", FLOAT, 32},
+            Register{"s11", FLOAT, 32}, Register{"s12", FLOAT, 32}, Register{"s13", FLOAT, 32}, Register{"s14", FLOAT, 32},
+            Register{"s15", FLOAT, 32}, Register{"s16", FLOAT, 32}, Register{"s17", FLOAT, 32}, Register{"s18", FLOAT, 32},
+            Register{"s19", FLOAT, 32}, Register{"s20", FLOAT, 32}, Register{"s21", FLOAT, 32}, Register{"s22", FLOAT, 32},
+            Register{"s23", FLOAT, 32}, Register{"s24", FLOAT, 32}, Register{"s25", FLOAT, 32}, Register{"s26", FLOAT, 32},
+            Register{"s27", FLOAT, 32}, Register{"s28", FLOAT, 32}, Register{"s29", FLOAT, 32}, Register{"s30", FLOAT, 32},
+            Register{"s31", FLOAT, 32}, Register{"d0", FLOAT, 64}, Register{"d1", FLOAT, 64}, Register{"d2", FLOAT, 64},
+            Register{"d3", FLOAT, 64}, Register{"d4", FLOAT, 64}, Register{"d5", FLOAT, 64}, Register{"d6", FLOAT, 64},
+            Register{"d7", FLOAT, 64}, Register{"d8", FLOAT, 64}, Register{"d9", FLOAT, 64}, Register{"d10", FLOAT, 64},
+            Register{"d11", FLOAT, 64}, Register{"d12", FLOAT, 64}, Register{"d13", FLOAT, 64}, Register{"d14", FLOAT, 64},
+            Register{"d15", FLOAT, 64}, Register{"d16", FLOAT, 64}, Register{"d17", FLOAT, 64}, Register{"d18", FLOAT, 64},
+            Register{"d19", FLOAT, 64}, Register{"d20", FLOAT, 64}, Register{"d21", FLOAT, 64}, Register{"d22", FLOAT, 64},
+            Register{"d23", FLOAT, 64}, Register{"d24", FLOAT, 64}, Register{"d25", FLOAT, 64}, Register{"d26", FLOAT, 64},
+            Register{"d27", FLOAT, 64}, Register{"d28", FLOAT, 64}, Register{"d29", FLOAT, 64}, Register{"d30", FLOAT, 64},
+            Register{"d31", FLOAT, 64}, Register{"q0", VECTOR, 128}, Register{"q1", VECTOR, 128}, Register{"q2", VECTOR, 128},
+            Register{"q3", VECTOR, 128}, Register{"q4", VECTOR, 128}, Register{"q5", VECTOR, 128}, Register{"q6", VECTOR, 128},
+            Register{"q7", VECTOR, 128}, Register{"q8", VECTOR, 128}, Register{"q9", VECTOR, 128}, Register{"q10", VECTOR, 128},
+            Register{"q11", VECTOR, 128}, Register{"q12", VECTOR, 128}, Register{"q13", VECTOR, 128}, Register{"q14", VECTOR, 128},
+            Register{"q15", VECTOR, 128}, Register{"q16", VECTOR, 128}, Register{"q17", VECTOR, 128}, Register{"q18", VECTOR, 128},
+            Register{"q19", VECTOR, 128}, Register{"q20", VECTOR, 128}, Register{"q21", VECTOR, 128}, Register{"q22", VECTOR, 128},
+            Register{"q23", VECTOR, 128}, Register{"q24", VECTOR, 128}, Register{"q25", VECTOR, 128}, Register{"q26", VECTOR, 128},
+            Register{"q27", VECTOR, 128}, Register{"q28", VECTOR, 128}, Register{"q29", VECTOR, 128}, Register{"q30", VECTOR, 128},
+            Register{"q31", VECTOR, 128}, Register{"v0", VECTOR, 128}, Register{"v1", VECTOR, 128}, Register{"v2", VECTOR, 128},
+            Register{"v3", VECTOR, 128}, Register{"v4", VECTOR, 128}, Register{"v5", VECTOR, 128}, Register{"v6", VECTOR, 128},
+            Register{"v7", VECTOR, 128}, Register{"v8", VECTOR, 128}, Register{"v9", VECTOR, 128}, Register{"v10", VECTOR, 128},
+            Register{"v11", VECTOR, 128}, Register{"v12", VECTOR, 128}, Register{"v13", VECTOR, 128}, Register{"v14", VECTOR, 128},
+            Register{"v15", VECTOR, 128}, Register{"v16", VECTOR, 128}, Register{"v17", VECTOR, 128}, Register{"v18", VECTOR, 128},
+            Register{"v19", VECTOR, 128}, Register{"v20", VECTOR, 128}, Register{"v21", VECTOR, 128}, Register{"v22", VECTOR, 128},
+            Register{"v23", VECTOR, 128}, Register{"v24", VECTOR, 128}, Register{"v25", VECTOR, 128}, Register{"v26", VECTOR, 128},
+            Register{"v27", VECTOR, 128}, Register{"v28", VECTOR, 128}, Register{"v29", VECTOR, 128}, Register{"v30", VECTOR, 128},
+            Register{"v31", VECTOR, 128}
+        };
+
+        inline constexpr phash::Table TABLE {REGISTERS};
+        inline constexpr size_t NAME_WIDTH = nameWidth(REGISTERS);
+
+        [[nodiscard]] constexpr auto lookup(std::string_view name) -> const Register* {
+            return TABLE.find(name);
+        }
+
+        static_assert(lookup("x29")->width == 64 && lookup("pc")->kind == POINTER && lookup("q15")->kind == VECTOR);
+    } // namespace arm
+
+    /**
+     * RV64, by number and by ABI name.
+     */
+    namespace riscv {
+        inline constexpr std::array REGISTERS = {
+            Register{"x0", GPR, 64}, Register{"x1", GPR, 64}, Register{"x2", GPR, 64}, Register{"x3", GPR, 64},
+            Register{"x4", GPR, 64}, Register{"x5", GPR, 64}, Register{"x6", GPR, 64}, Register{"x7", GPR, 64},
+            Register{"x8", GPR, 64}, Register{"x9", GPR, 64}, Register{"x10", GPR, 64}, Register{"x11", GPR, 64},
+            Register{"x12", GPR, 64}, Register{"x13", GPR, 64}, Register{"x14", GPR, 64}, Register{"x15", GPR, 64},
+            Register{"x16", GPR, 64}, Register{"x17", GPR, 64}, Register{"x18", GPR, 64}, Register{"x19", GPR, 64},
+            Register{"x20", GPR, 64}, Register{"x21", GPR, 64}, Register{"x22", GPR, 64}, Register{"x23", GPR, 64},
+            Register{"x24", GPR, 64}, Register{"x25", GPR, 64}, Register{"x26", GPR, 64}, Register{"x27", GPR, 64},
+            Register{"x28", GPR, 64}, Register{"x29", GPR, 64}, Register{"x30", GPR, 64}, Register{"x31", GPR, 64},
+            Register{"zero", GPR, 64}, Register{"ra", GPR, 64}, Register{"sp", GPR, 64}, Register{"gp", GPR, 64},
+            Register{"tp", GPR, 64}, Register{"t0", GPR, 64}, Register{"t1", GPR, 64}, Register{"t2", GPR, 64},
+            Register{"t3", GPR, 64}, Register{"t4", GPR, 64}, Register{"t5", GPR, 64}, Register{"t6", GPR, 64},
+            Register{"s0", GPR, 64}, Register{"s1", GPR, 64}, Register{"s2", GPR, 64}, Register{"s3", GPR, 64},
+            Register{"s4", GPR, 64}, Register{"s5", GPR, 64}, Register{"s6", GPR, 64}, Register{"s7", GPR, 64},
+            Register{"s8", GPR, 64}, Register{"s9", GPR, 64}, Register{"s10", GPR, 64}, Register{"s11", GPR, 64},
+            Register{"fp", GPR, 64}, Register{"a0", GPR, 64}, Register{"a1", GPR, 64}, Register{"a2", GPR, 64},
+            Register{"a3", GPR, 64}, Register{"a4", GPR, 64}, Register{"a5", GPR, 64}, Register{"a6", GPR, 64},
+            Register{"a7", GPR, 64}, Register{"f0", FLOAT, 64}, Register{"f1", FLOAT, 64}, Register{"f2", FLOAT, 64},
+            Register{"f3", FLOAT, 64}, Register{"f4", FLOAT, 64}, Register{"f5", FLOAT, 64}, Register{"f6", FLOAT, 64},
+            Register{"f7", FLOAT, 64}, Register{"f8", FLOAT, 64}, Register{"f9", FLOAT, 64}, Register{"f10", FLOAT, 64},
+            Register{"f11", FLOAT, 64}, Register{"f12", FLOAT, 64}, Register{"f13", FLOAT, 64}, Register{"f14", FLOAT, 64},
+            Register{"f15", FLOAT, 64}, Register{"f16", FLOAT, 64}, Register{"f17", FLOAT, 64}, Register{"f18", FLOAT, 64},
+            Register{"f19", FLOAT, 64}, Register{"f20", FLOAT, 64}, Register{"f21", FLOAT, 64}, Register{"f22", FLOAT, 64},
+            Register{"f23", FLOAT, 64}, Register{"f24", FLOAT, 64}, Register{"f25", FLOAT, 64}, Register{"f26", FLOAT, 64},
+            Register{"f27", FLOAT, 64}, Register{"f28", FLOAT, 64}, Register{"f29", FLOAT, 64}, Register{"f30", FLOAT, 64},
+            Register{"f31", FLOAT, 64}, Register{"ft0", FLOAT, 64}, Register{"ft1", FLOAT, 64}, Register{"ft2", FLOAT, 64},
+            Register{"ft3", FLOAT, 64}, Register{"ft4", FLOAT, 64}, Register{"ft5", FLOAT, 64}, Register{"ft6", FLOAT, 64},
+            Register{"ft7", FLOAT, 64}, Register{"ft8", FLOAT, 64}, Register{"ft9", FLOAT, 64}, Register{"ft10", FLOAT, 64},
+            Register{"ft11", FLOAT, 64}, Register{"fs0", FLOAT, 64}, Register{"fs1", FLOAT, 64}, Register{"fs2", FLOAT, 64},
+            Register{"fs3", FLOAT, 64}, Register{"fs4", FLOAT, 64}, Register{"fs5", FLOAT, 64}, Register{"fs6", FLOAT, 64},
+            Register{"fs7", FLOAT, 64}, Register{"fs8", FLOAT, 64}, Register{"fs9", FLOAT, 64}, Register{"fs10", FLOAT, 64},
+            Register{"fs11", FLOAT, 64}, Register{"fa0", FLOAT, 64}, Register{"fa1", FLOAT, 64}, Register{"fa2", FLOAT, 64},
+            Register{"fa3", FLOAT, 64}, Register{"fa4", FLOAT, 64}, Register{"fa5", FLOAT, 64}, Register{"fa6", FLOAT, 64},
+            Register{"fa7", FLOAT, 64}
+        };
+
+        inline constexpr phash::Table TABLE {REGISTERS};
+        inline constexpr size_t NAME_WIDTH = nameWidth(REGISTERS);
+
+        [[nodiscard]] constexpr auto lookup(std::string_view name) -> const Register* {
+            return TABLE.find(name);
+        }
+
+        static_assert(lookup("a0")->kind == GPR && lookup("fa7")->kind == FLOAT && lookup("x32") == nullptr);
+    } // namespace riscv
+
+    /**
+     * MIPS32, by number and by name, with their `$`.
+     */
+    namespace mips {
+        inline constexpr std::array REGISTERS = {
+            Register{"$0", GPR, 32}, Register{"$1", GPR, 32}, Register{"$2", GPR, 32}, Register{"$3", GPR, 32},
+            Register{"$4", GPR, 32}, Register{"$5", GPR, 32}, Register{"$6", GPR, 32}, Register{"$7", GPR, 32},
+            Register{"$8", GPR, 32}, Register{"$9", GPR, 32}, Register{"$10", GPR, 32}, Register{"$11", GPR, 32},
+            Register{"$12", GPR, 32}, Register{"$13", GPR, 32}, Register{"$14", GPR, 32}, Register{"$15", GPR, 32},
+            Register{"$16", GPR, 32}, Register{"$17", GPR, 32}, Register{"$18", GPR, 32}, Register{"$19", GPR, 32},
+            Register{"$20", GPR, 32}, Register{"$21", GPR, 32}, Register{"$22", GPR, 32}, Register{"$23", GPR, 32},
+            Register{"$24", GPR, 32}, Register{"$25", GPR, 32}, Register{"$26", GPR, 32}, Register{"$27", GPR, 32},
+            Register{"$28", GPR, 32}, Register{"$29", GPR, 32}, Register{"$30", GPR, 32}, Register{"$31", GPR, 32},
+            Register{"$zero", GPR, 32}, Register{"$at", GPR, 32}, Register{"$v0", GPR, 32}, Register{"$v1", GPR, 32},
+            Register{"$a0", GPR, 32}, Register{"$a1", GPR, 32}, Register{"$a2", GPR, 32}, Register{"$a3", GPR, 32},
+            Register{"$t0", GPR, 32}, Register{"$t1", GPR, 32}, Register{"$t2", GPR, 32}, Register{"$t3", GPR, 32},
+            Register{"$t4", GPR, 32}, Register{"$t5", GPR, 32}, Register{"$t6", GPR, 32}, Register{"$t7", GPR, 32},
+            Register{"$t8", GPR, 32}, Register{"$t9", GPR, 32}, Register{"$s0", GPR, 32}, Register{"$s1", GPR, 32},
+            Register{"$s2", GPR, 32}, Register{"$s3", GPR, 32}, Register{"$s4", GPR, 32}, Register{"$s5", GPR, 32},
+            Register{"$s6", GPR, 32}, Register{"$s7", GPR, 32}, Register{"$s8", GPR, 32}, Register{"$k0", GPR, 32},
+            Register{"$k1", GPR, 32}, Register{"$gp", GPR, 32}, Register{"$sp", GPR, 32}, Register{"$fp", GPR, 32},
+            Register{"$ra", GPR, 32}, Register{"$f0", FLOAT, 32}, Register{"$f1", FLOAT, 32}, Register{"$f2", FLOAT, 32},
+            Register{"$f3", FLOAT, 32}, Register{"$f4", FLOAT, 32}, Register{"$f5", FLOAT, 32}, Register{"$f6", FLOAT, 32},
+            Register{"$f7", FLOAT, 32}, Register{"$f8", FLOAT, 32}, Register{"$f9", FLOAT, 32}, Register{"$f10", FLOAT, 32},
+            Register{"$f11", FLOAT, 32}, Register{"$f12", FLOAT, 32}, Register{"$f13", FLOAT, 32}, Register{"$f14", FLOAT, 32},
+            Register{"$f15", FLOAT, 32}, Register{"$f16", FLOAT, 32}, Register{"$f17", FLOAT, 32}, Register{"$f18", FLOAT, 32},
+            Register{"$f19", FLOAT, 32}, Register{"$f20", FLOAT, 32}, Register{"$f21", FLOAT, 32}, Register{"$f22", FLOAT, 32},
+            Register{"$f23", FLOAT, 32}, Register{"$f24", FLOAT, 32}, Register{"$f25", FLOAT, 32}, Register{"$f26", FLOAT, 32},
+            Register{"$f27", FLOAT, 32}, Register{"$f28", FLOAT, 32}, Register{"$f29", FLOAT, 32}, Register{"$f30", FLOAT, 32},
+            Register{"$f31", FLOAT, 32}, Register{"hi", GPR, 32}, Register{"lo", GPR, 32}
+        };
+
+        inline constexpr phash::Table TABLE {REGISTERS};
+        inline constexpr size_t NAME_WIDTH = nameWidth(REGISTERS);
+
+        [[nodiscard]] constexpr auto lookup(std::string_view name) -> const Register* {
+            return TABLE.find(name);
+        }
+
+        static_assert(lookup("$ra")->kind == GPR && lookup("$f31")->kind == FLOAT && lookup("ra") == nullptr);
+    } // namespace mips
+} // namespace registers
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <input.hpp>
+
+#include <string_view>
+#include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <string>
+#include <cerrno>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#endif
+
+/**
+ * A namespace for the resident analyzer (--serve) and its clients.
+ *
+ * The daemon listens on a Unix domain socket and takes one request per connection,
+ * a line optionally followed by a payload:
+ *
+ *     FILE <input>[\t<output>]\n   analyze a file as `asm-analyze input [-o output]` would
+ *     BUFFER <size>\n<bytes>      analyze the bytes and stream the annotated text back
+ *
+ * and answers with `OK\n` (followed, for BUFFER, by the text until the connection
+ * closes) or `ERROR <message>\n`. Paths are resolved by the daemon, so clients send
+ * absolute ones. BUFFER bytes are analyzed as they arrive and the text is sent back
+ * meanwhile, so clients keep reading the reply while they send the payload.
+ *
+ * The daemon acts with its own rights, so only its user may talk to it: the socket is
+ * created 0600 and connections from other users are refused (where the peer's
+ * credentials are known).
+ */
+namespace serve {
+    inline constexpr std::string_view FILE_REQUEST = "FILE ";
+    inline constexpr std::string_view BUFFER_REQUEST = "BUFFER ";
+    inline constexpr std::string_view OK_REPLY = "OK\n";
+    inline constexpr std::string_view ERROR_REPLY = "ERROR ";
+
+    /**
+     * How long a connection may stay idle (no byte read or written) before the daemon drops it.
+     */
+    inline constexpr int IDLE_SECONDS = 30;
+
+    /**
+     * The largest BUFFER payload accepted (1 GiB); larger files are sent as FILE requests.
+     */
+    inline constexpr uint64_t BUFFER_LIMIT = static_cast<uint64_t>(1) << 30;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    /**
+     * An owned file descriptor.
+     */
+    class Descriptor {
+    public:
+        Descriptor() = default;
+        explicit Descriptor(int fd) : fd_(fd) {}
+
+        Descriptor(const Descriptor&) = delete;
+        auto operator=(const Descriptor&) -> Descriptor& = delete;
+
+        Descriptor(Descriptor&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+
+        auto operator=(Descriptor&& other) noexcept -> Descriptor& {
+            if (this != &other) {
+                reset();
+                fd_ = std::exchange(other.fd_, -1);
+            }
+            return *this;
+        }
+
+        ~Descriptor() { reset(); }
+
+        [[nodiscard]] explicit operator bool() const { return fd_ >= 0; }
+
+        [[nodiscard]] auto get() const -> int { return fd_; }
+
+        void reset() {
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+        }
+
+    private:
+        int fd_ = -1;
+    };
+
+    /**
+     * Set by SIGINT or SIGTERM once stopOnSignals() is installed.
+     */
+    inline std::atomic<bool> stopping = false;
+
+    /**
+     * Makes SIGINT and SIGTERM stop the daemon (interrupting a pending accept()), and
+     * turns writes to clients that went away into errors instead of SIGPIPE.
+     */
+    inline void stopOnSignals() {
+        struct sigaction action {};
+        action.sa_handler = [](int /*signal*/) { stopping = true; };
+        sigemptyset(&action.sa_mask);
+        ::sigaction(SIGINT, &action, nullptr);
+        ::sigaction(SIGTERM, &action, nullptr);
+        ::signal(SIGPIPE, SIG_IGN);
+    }
+
+    namespace detail {
+        [[nodiscard]] inline auto address(const std::string& path, sockaddr_un& addr) -> bool {
+            addr = {};
+            addr.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+            std::memcpy(addr.sun_path, path.data(), path.size());
+            return true;
+        }
+    } // namespace detail
+
+    /**
+     * Connects to a daemon.
+     *
+     * @return The connection, or an invalid descriptor (errno tells why).
+     */
+    [[nodiscard]] inline auto connect(const std::string& path) -> Descriptor {
+        sockaddr_un addr {};
+        if (!detail::address(path, addr)) {
+            errno = ENAMETOOLONG;
+            return {};
+        }
+        Descriptor socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!socket) return {};
+        if (::connect(socket.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) return {};
+        return socket;
+    }
+
+    /**
+     * Listens on `path`, replacing a stale socket left by a daemon that died.
+     *
+     * @param error Receives why it failed.
+     * @return The listening socket, or an invalid descriptor.
+     */
+    [[nodiscard]] inline auto listen(const std::string& path, std::string& error) -> Descriptor {
+        sockaddr_un addr {};
+        if (!detail::address(path, addr)) {
+            error = "Socket path too long: " + path;
+            return {};
+        }
+        if (connect(path)) {
+            error = "Already serving on " + path;
+            return {};
+        }
+        if (errno == ECONNREFUSED) ::unlink(path.c_str());
+
+        // The socket file is created for the owner only
+        Descriptor socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        mode_t mask = ::umask(077);
+        bool bound = socket && ::bind(socket.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        int bindError = errno;
+        ::umask(mask);
+        if (!bound || ::listen(socket.get(), SOMAXCONN) != 0) {
+            error = "Cannot listen on " + path + ": " + std::strerror(bound ? errno : bindError);
+            return {};
+        }
+        return socket;
+    }
+
+    /**
+     * @return Whether the peer of a connection runs as the daemon's user (or as root).
+     */
+    [[nodiscard]] inline auto trusted(int fd) -> bool {
+#if defined(SO_PEERCRED)
+        ucred peer {};
+        socklen_t size = sizeof(peer);
+        if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &size) != 0) return false;
+        return peer.uid == ::geteuid() || peer.uid == 0;
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+        uid_t uid = 0;
+        gid_t gid = 0;
+        if (::getpeereid(fd, &uid, &gid) != 0) return false;
+        return uid == ::geteuid() || uid == 0;
+#else
+        static_cast<void>(fd);
+        return true; // only the permissions of the socket keep others out
+#endif
+    }
+
+    /**
+     * Waits for a connection. Its reads and writes fail once it is idle for IDLE_SECONDS,
+     * so a client that stops talking only holds a worker that long.
+     *
+     * @param timeout How long to wait, in milliseconds.
+     * @return The connection, or an invalid descriptor on timeout or interruption.
+     */
+    [[nodiscard]] inline auto accept(const Descriptor& socket, int timeout) -> Descriptor {
+        pollfd pending {socket.get(), POLLIN, 0};
+        if (::poll(&pending, 1, timeout) <= 0) return {};
+        Descriptor connection(::accept4(socket.get(), nullptr, nullptr, SOCK_CLOEXEC));
+        if (connection) {
+            timeval idle {IDLE_SECONDS, 0};
+            ::setsockopt(connection.get(), SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof(idle));
+            ::setsockopt(connection.get(), SOL_SOCKET, SO_SNDTIMEO, &idle, sizeof(idle));
+        }
+        return connection;
+    }
+
+    /**
+     * Writes all of `data`.
+     *
+     * @return False if the peer went away.
+     */
+    [[nodiscard]] inline auto writeAll(int fd, std::string_view data) -> bool {
+        while (!data.empty()) {
+            ssize_t written = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    /**
+     * Buffered reads from a connection.
+     */
+    class Reader {
+    public:
+        explicit Reader(int fd) : fd_(fd) {}
+
+        /**
+         * Reads up to the next '\n' (dropped).
+         *
+         * @param limit The longest line accepted.
+         * @return False at the end of the stream, on an error or past `limit`.
+         */
+        [[nodiscard]] auto line(std::string& out, size_t limit) -> bool {
+            for (;;) {
+                size_t end = buffer_.find('\n', pos_);
+                if (end != std::string::npos) {
+                    out.assign(buffer_, pos_, end - pos_);
+                    pos_ = end + 1;
+                    return true;
+                }
+                if (buffer_.size() - pos_ > limit || !fill()) return false;
+            }
+        }
+
+        /**
+         * Reads `size` bytes into `data`.
+         *
+         * @return The number of bytes read, which is `size` unless the stream ended or failed.
+         */
+        [[nodiscard]] auto read(char* data, size_t size) -> size_t {
+            size_t got = std::min(size, buffer_.size() - pos_);
+            std::memcpy(data, buffer_.data() + pos_, got);
+            pos_ += got;
+            while (got < size) {
+                ssize_t n = ::recv(fd_, data + got, size - got, 0);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                got += static_cast<size_t>(n);
+            }
+            return got;
+        }
+
+        /**
+         * Hands everything until the end of the stream to `sink`, a block at a time.
+         *
+         * @return False on a read error.
+         */
+        template <typename Sink>
+        [[nodiscard]] auto drain(Sink sink) -> bool {
+            if (pos_ < buffer_.size()) sink(std::string_view(buffer_).substr(pos_));
+            buffer_.clear();
+            pos_ = 0;
+            while (fill()) {
+                sink(std::string_view(buffer_));
+                buffer_.clear();
+            }
+            return error_ == 0;
+        }
+
+    private:
+        static constexpr size_t READ_SIZE = static_cast<size_t>(64) << 10;
+
+        auto fill() -> bool {
+            if (pos_ > 0) {
+                buffer_.erase(0, pos_);
+                pos_ = 0;
+            }
+            size_t size = buffer_.size();
+            buffer_.resize(size + READ_SIZE);
+            for (;;) {
+                ssize_t n = ::recv(fd_, buffer_.data() + size, READ_SIZE, 0);
+                if (n < 0 && errno == EINTR) continue;
+                buffer_.resize(size + static_cast<size_t>(n < 0 ? 0 : n));
+                if (n < 0) error_ = errno;
+                return n > 0;
+            }
+        }
+
+        int fd_;
+        std::string buffer_;
+        size_t pos_ = 0;
+        int error_ = 0;
+    };
+
+    /**
+     * The payload of a BUFFER request, read from the connection as it is analyzed.
+     */
+    class Payload final : public io::Reader {
+    public:
+        /**
+         * @param reader The connection, past the request line.
+         * @param size The announced payload size.
+         */
+        Payload(serve::Reader& reader, uint64_t size) : reader_(reader), remaining_(size) {}
+
+        /**
+         * @throws std::runtime_error if the connection ends before the announced size.
+         */
+        [[nodiscard]] auto read(char* data, size_t size) -> size_t override {
+            size_t wanted = static_cast<size_t>(std::min<uint64_t>(size, remaining_));
+            size_t got = reader_.read(data, wanted);
+            if (got < wanted) throw std::runtime_error("Connection lost");
+            remaining_ -= got;
+            return got;
+        }
+
+    private:
+        serve::Reader& reader_;
+        uint64_t remaining_;
+    };
+#endif
+
+    /**
+     * Parses the size of a BUFFER request.
+     *
+     * @return False if it is not a number.
+     */
+    [[nodiscard]] inline auto parseSize(std::string_view text, uint64_t& size) -> bool {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), size);
+        return ec == std::errc() && end == text.data() + text.size();
+    }
+} // namespace serve
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <analysis.hpp>
+
+#include <string_view>
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <array>
+#include <mutex>
+#include <cstdio>
+
+#if defined(ASM_ANALYZE_STATS) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+/**
+ * A namespace for run statistics.
+ *
+ * Totals (files, bytes, lines, memo hits, headers, incremental chunks, compressed bytes) are always kept; they are counted once per chunk.
+ * The hot-path instrumentation (per-stage time, line kinds, opcode and directive
+ * histograms) only exists when ASM_ANALYZE_STATS is defined; otherwise every hook
+ * is an empty inline function and compiles away.
+ */
+namespace stats {
+    /**
+     * Enumerates the instrumented pipeline stages.
+     */
+    enum Stage : uint8_t {
+        /**
+         * Opening or reading the input and splitting it into lines.
+         */
+        READ,
+        /**
+         * Architecture detection and line classification.
+         */
+        CLASSIFY,
+        OPERANDS,
+        FORMAT,
+        /**
+         * Handing the output to the writer, including waiting for it.
+         */
+        WRITE,
+        STAGE_COUNT
+    };
+
+    inline constexpr std::array<std::string_view, STAGE_COUNT> STAGE_NAMES = {"read", "classify", "operands", "format", "write"};
+
+    inline constexpr std::array<std::string_view, analysis::UNKNOWN + 1> KIND_NAMES = {
+        "blank", "label", "instruction", "directive", "unknown_instruction"
+    };
+
+    /**
+     * Whether the instrumentation is compiled in.
+     */
+#ifdef ASM_ANALYZE_STATS
+    inline constexpr bool INSTRUMENTED = true;
+#else
+    inline constexpr bool INSTRUMENTED = false;
+#endif
+
+    /**
+     * Whether the hooks record anything (set by --stats).
+     */
+    inline bool enabled = false;
+
+    /**
+     * The counters of the hot path.
+     */
+    struct Counters {
+        std::array<uint64_t, STAGE_COUNT> ticks {};
+        std::array<uint64_t, analysis::UNKNOWN + 1> kinds {};
+        std::array<uint64_t, opcodes::NONE + 1> opcodes {};
+        std::array<uint64_t, directives::NONE + 1> directives {};
+
+        void add(const Counters& other) {
+            for (size_t i = 0; i < ticks.size(); ++i) ticks[i] += other.ticks[i];
+            for (size_t i = 0; i < kinds.size(); ++i) kinds[i] += other.kinds[i];
+            for (size_t i = 0; i < opcodes.size(); ++i) opcodes[i] += other.opcodes[i];
+            for (size_t i = 0; i < directives.size(); ++i) directives[i] += other.directives[i];
+        }
+    };
+
+    /**
+     * Run-wide totals and merged counters.
+     */
+    struct Totals {
+        std::atomic<uint64_t> files = 0;
+        std::atomic<uint64_t> cached = 0;
+        std::atomic<uint64_t> bytes = 0;
+        std::atomic<uint64_t> lines = 0;
+        std::atomic<uint64_t> memoHits = 0; // lines whose comment came from the memo (see etc/memo.hpp)
+        std::atomic<uint64_t> memoMisses = 0;
+        std::atomic<uint64_t> headers = 0; // included files analyzed (see etc/includes.hpp)
+        std::atomic<uint64_t> headersReused = 0;
+        std::atomic<uint64_t> chunksReused = 0; // --incremental chunks copied from the previous output
+        std::atomic<uint64_t> chunksAnalyzed = 0;
+        std::atomic<uint64_t> compressedRead = 0; // bytes of .gz/.zst inputs (see etc/compression.hpp)
+        std::atomic<uint64_t> compressedWritten = 0;
+
+        std::mutex mutex;
+        Counters counters; // guarded by mutex
+    };
+
+    [[nodiscard]] inline auto totals() -> Totals& {
+        static Totals instance;
+        return instance;
+    }
+
+    /**
+     * @return A cheap timestamp (the TSC where available, nanoseconds otherwise).
+     */
+    [[nodiscard]] inline auto now() -> uint64_t {
+#if defined(ASM_ANALYZE_STATS) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+#ifdef ASM_ANALYZE_STATS
+    namespace detail {
+        struct Local {
+            Counters counters;
+            uint64_t last = 0;
+        };
+
+        [[nodiscard]] inline auto local() -> Local& {
+            thread_local Local instance;
+            return instance;
+        }
+    } // namespace detail
+
+    /**
+     * Starts timing on this thread; the next lap() is measured from here.
+     */
+    inline void start() {
+        if (enabled) detail::local().last = now();
+    }
+
+    /**
+     * Charges the time since the previous start() or lap() on this thread to `stage`.
+     */
+    inline void lap(Stage stage) {
+        if (!enabled) return;
+        detail::Local& local = detail::local();
+        uint64_t time = now();
+        local.counters.ticks[stage] += time - local.last;
+        local.last = time;
+    }
+
+    /**
+     * Counts an analyzed line.
+     */
+    inline void count(const analysis::Record& record) {
+        if (!enabled) return;
+        Counters& counters = detail::local().counters;
+        ++counters.kinds[record.kind];
+        if (record.kind == analysis::INSTRUCTION) ++counters.opcodes[record.opcode];
+        else if (record.kind == analysis::DIRECTIVE) ++counters.directives[record.directive];
+    }
+
+    /**
+     * Merges this thread's counters into the totals.
+     */
+    inline void flush() {
+        if (!enabled) return;
+        Counters& counters = detail::local().counters;
+        std::lock_guard<std::mutex> lock(totals().mutex);
+        totals().counters.add(counters);
+        counters = Counters();
+    }
+#else
+    inline void start() {}
+    inline void lap(Stage /*stage*/) {}
+    inline void count(const analysis::Record& /*record*/) {}
+    inline void flush() {}
+#endif
+
+    /**
+     * Charges the lifetime of the scope to `stage`.
+     */
+    class Scope {
+    public:
+        explicit Scope(Stage stage) : stage_(stage) { start(); }
+        ~Scope() { lap(stage_); }
+
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+
+    private:
+        [[maybe_unused]] Stage stage_;
+    };
+
+    namespace detail {
+        inline void appendNumber(std::string& out, double value) {
+            char buffer[32];
+            int size = std::snprintf(buffer, sizeof(buffer), "%.6f", value);
+            out.append(buffer, static_cast<size_t>(size));
+        }
+
+        template <typename Entry, size_t N, size_t M>
+        void appendHistogram(std::string& out, std::string_view name, const std::array<Entry, N>& entries,
+                             const std::array<uint64_t, M>& counts, std::string_view unknown) {
+            out += ",\n  \"";
+            out += name;
+            out += "\": {";
+            bool first = true;
+            for (size_t id = 0; id < M; ++id) {
+                if (counts[id] == 0) continue;
+                std::string_view label = unknown;
+                for (const Entry& entry : entries) {
+                    if (entry.id == id) label = entry.name;
+                }
+                out += first ? "" : ", ";
+                out += '"';
+                out += label;
+                out += "\": ";
+                out += std::to_string(counts[id]);
+                first = false;
+            }
+            out += '}';
+        }
+    } // namespace detail
+
+    /**
+     * Renders the totals as JSON.
+     *
+     * @param version The analyzer version.
+     * @param seconds The wall-clock time of the run.
+     * @param ticks The now() delta over the same run, to convert stage ticks into seconds.
+     */
+    [[nodiscard]] inline auto json(std::string_view version, double seconds, uint64_t ticks) -> std::string {
+        Totals& run = totals();
+        double bytes = static_cast<double>(run.bytes);
+        double lines = static_cast<double>(run.lines);
+        double rate = seconds > 0 ? 1.0 / seconds : 0.0;
+
+        std::string out = "{\n  \"version\": \"";
+        out += version;
+        out += "\",\n  \"instrumented\": ";
+        out += INSTRUMENTED ? "true" : "false";
+        out += ",\n  \"seconds\": ";
+        detail::appendNumber(out, seconds);
+        out += ",\n  \"files\": " + std::to_string(run.files);
+        out += ",\n  \"cached\": " + std::to_string(run.cached);
+        out += ",\n  \"bytes\": " + std::to_string(run.bytes);
+        out += ",\n  \"lines\": " + std::to_string(run.lines);
+        uint64_t lookups = run.memoHits + run.memoMisses;
+        out += ",\n  \"memo\": {\"hits\": " + std::to_string(run.memoHits) + ", \"misses\": " + std::to_string(run.memoMisses) + ", \"hit_rate\": ";
+        detail::appendNumber(out, lookups > 0 ? static_cast<double>(run.memoHits) / static_cast<double>(lookups) : 0.0);
+        out += '}';
+        out += ",\n  \"includes\": {\"analyzed\": " + std::to_string(run.headers) + ", \"reused\": " + std::to_string(run.headersReused) + '}';
+        out += ",\n  \"incremental\": {\"reused\": " + std::to_string(run.chunksReused) + ", \"analyzed\": " + std::to_string(run.chunksAnalyzed) + '}';
+        out += ",\n  \"compressed\": {\"read\": " + std::to_string(run.compressedRead) + ", \"written\": " + std::to_string(run.compressedWritten) + '}';
+        out += ",\n  \"lines_per_second\": ";
+        detail::appendNumber(out, lines * rate);
+        out += ",\n  \"megabytes_per_second\": ";
+        detail::appendNumber(out, bytes / (1024.0 * 1024.0) * rate);
+
+        if constexpr (INSTRUMENTED) {
+            std::lock_guard<std::mutex> lock(run.mutex);
+            const Counters& counters = run.counters;
+
+            // Stage times are summed over all threads
+            double perTick = ticks > 0 ? seconds / static_cast<double>(ticks) : 0.0;
+            uint64_t staged = 0;
+            for (uint64_t stage : counters.ticks) staged += stage;
+            out += ",\n  \"stages\": {";
+            for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+                out += stage == 0 ? "\n    \"" : ",\n    \"";
+                out += STAGE_NAMES[stage];
+                out += "\": {\"ticks\": " + std::to_string(counters.ticks[stage]) + ", \"seconds\": ";
+                detail::appendNumber(out, static_cast<double>(counters.ticks[stage]) * perTick);
+                out += ", \"share\": ";
+                detail::appendNumber(out, staged > 0 ? static_cast<double>(counters.ticks[stage]) / static_cast<double>(staged) : 0.0);
+                out += '}';
+            }
+            out += "\n  }";
+
+            out += ",\n  \"kinds\": {";
+            for (size_t kind = 0; kind < KIND_NAMES.size(); ++kind) {
+                out += kind == 0 ? "\"" : ", \"";
+                out += KIND_NAMES[kind];
+                out += "\": " + std::to_string(counters.kinds[kind]);
+            }
+            out += '}';
+
+            detail::appendHistogram(out, "opcodes", opcodes::OPERATIONS, counters.opcodes, "unknown");
+            detail::appendHistogram(out, "directives", directives::DIRECTIVES, counters.directives, "unknown");
+        }
+        out += "\n}\n";
+        return out;
+    }
+} // namespace stats
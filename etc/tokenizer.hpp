@@ -0,0 +1,455 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ASM_ANALYZE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/**
+ * A namespace for the single-pass line tokenizer.
+ *
+ * Text is classified 64 bytes at a time into bitmasks (newlines, spaces, blanks,
+ * commas) with the widest instruction set the CPU supports, chosen at runtime.
+ * The spans the analysis needs (the trimmed line, the mnemonic, the operands and
+ * their first comma and space) are resolved from the masks while looking for the
+ * end of the line, so each byte is loaded about once.
+ *
+ * The spans follow the scalar helpers exactly: trimming only strips spaces, and
+ * the operand is everything after the first space of the untrimmed line.
+ */
+namespace scan {
+    inline constexpr size_t npos = std::string_view::npos;
+    inline constexpr size_t BLOCK = 64;
+
+    /**
+     * Classified bytes of a block; bit i describes byte i.
+     */
+    struct Masks {
+        uint64_t newline = 0;
+        uint64_t space = 0;
+        /**
+         * ' ', '\t', '\r' or '\n'.
+         */
+        uint64_t blank = 0;
+        uint64_t comma = 0;
+    };
+
+    /**
+     * Enumerates the block classifiers.
+     */
+    enum Level : uint8_t {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    inline constexpr std::array<std::string_view, AVX2 + 1> LEVEL_NAMES = {"scalar", "sse2", "avx2"};
+
+    namespace detail {
+        [[nodiscard]] inline auto scalarBlock(const char* p) -> Masks {
+            Masks masks;
+            for (size_t i = 0; i < BLOCK; ++i) {
+                uint64_t bit = uint64_t{1} << i;
+                switch (p[i]) {
+                case '\n':
+                    masks.newline |= bit;
+                    masks.blank |= bit;
+                    break;
+                case ' ':
+                    masks.space |= bit;
+                    masks.blank |= bit;
+                    break;
+                case '\t': case '\r':
+                    masks.blank |= bit;
+                    break;
+                case ',':
+                    masks.comma |= bit;
+                    break;
+                default:
+                    break;
+                }
+            }
+            return masks;
+        }
+
+#ifdef ASM_ANALYZE_X86_SIMD
+        __attribute__((target("sse2"))) inline auto sse2Equal(const __m128i* v, char c) -> uint64_t {
+            __m128i needle = _mm_set1_epi8(c);
+            uint64_t mask = 0;
+            for (int i = 0; i < 4; ++i)
+                mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], needle)))) << (16 * i);
+            return mask;
+        }
+
+        __attribute__((target("sse2"))) inline auto sse2Block(const char* p) -> Masks {
+            __m128i v[4];
+            for (int i = 0; i < 4; ++i) v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+
+            Masks masks;
+            masks.newline = sse2Equal(v, '\n');
+            masks.space = sse2Equal(v, ' ');
+            masks.comma = sse2Equal(v, ',');
+            masks.blank = masks.newline | masks.space | sse2Equal(v, '\t') | sse2Equal(v, '\r');
+            return masks;
+        }
+
+        __attribute__((target("avx2"))) inline auto avx2Equal(__m256i lo, __m256i hi, char c) -> uint64_t {
+            __m256i needle = _mm256_set1_epi8(c);
+            auto low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+            auto high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+            return (static_cast<uint64_t>(high) << 32) | low;
+        }
+
+        __attribute__((target("avx2"))) inline auto avx2Block(const char* p) -> Masks {
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+            Masks masks;
+            masks.newline = avx2Equal(lo, hi, '\n');
+            masks.space = avx2Equal(lo, hi, ' ');
+            masks.comma = avx2Equal(lo, hi, ',');
+            masks.blank = masks.newline | masks.space | avx2Equal(lo, hi, '\t') | avx2Equal(lo, hi, '\r');
+            return masks;
+        }
+#endif
+
+        /**
+         * @return The best level the CPU supports, capped by $ASM_ANALYZE_SIMD (scalar, sse2 or avx2).
+         */
+        [[nodiscard]] inline auto detect() -> Level {
+            Level level = SCALAR;
+#ifdef ASM_ANALYZE_X86_SIMD
+            __builtin_cpu_init();
+            level = __builtin_cpu_supports("avx2") ? AVX2 : __builtin_cpu_supports("sse2") ? SSE2 : SCALAR;
+#endif
+            if (const char* cap = std::getenv("ASM_ANALYZE_SIMD")) {
+                for (size_t i = 0; i < LEVEL_NAMES.size(); ++i) {
+                    if (LEVEL_NAMES[i] == cap && i < level) level = static_cast<Level>(i);
+                }
+            }
+            return level;
+        }
+
+        [[nodiscard]] constexpr auto from(int64_t bit) -> uint64_t {
+            if (bit <= 0) return ~uint64_t{0};
+            if (bit >= 64) return 0;
+            return ~uint64_t{0} << bit;
+        }
+    } // namespace detail
+
+    using BlockFunction = Masks (*)(const char*);
+
+    /**
+     * The level the block classifier was chosen for.
+     */
+    inline const Level LEVEL = detail::detect();
+
+    inline const BlockFunction CLASSIFY = [] {
+        switch (LEVEL) {
+#ifdef ASM_ANALYZE_X86_SIMD
+        case AVX2: return &detail::avx2Block;
+        case SSE2: return &detail::sse2Block;
+#endif
+        default: return &detail::scalarBlock;
+        }
+    }();
+
+    /**
+     * Writes `text` with 'A'-'Z' lowercased (like std::tolower in the "C" locale) to `out`,
+     * eight bytes at a time.
+     */
+    inline void lower(std::string_view text, char* out) {
+        constexpr uint64_t ONES = 0x0101010101010101ULL;
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            uint64_t x = 0;
+            std::memcpy(&x, text.data() + i, 8);
+            uint64_t heptets = x & (0x7F * ONES);
+            uint64_t upper = ((heptets + (0x80 - 'A') * ONES) ^ (heptets + (0x80 - 'Z' - 1) * ONES)) & ~x & (0x80 * ONES);
+            x |= upper >> 2;
+            std::memcpy(out + i, &x, 8);
+        }
+        for (; i < text.size(); ++i) {
+            char c = text[i];
+            out[i] = c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+    }
+
+    /**
+     * Positions within the operands of an instruction.
+     */
+    struct Split {
+        size_t comma = npos; // first ','
+        size_t space = npos; // first ' '
+    };
+
+    /**
+     * @return The first comma and space of `operands`.
+     */
+    [[nodiscard]] inline auto split(std::string_view operands) -> Split {
+        return {operands.find(','), operands.find(' ')};
+    }
+
+    /**
+     * A tokenized line. Positions are offsets into `text`.
+     */
+    struct Line {
+        std::string_view text;
+        /**
+         * Whether the line only holds ' ', '\t' and '\r'.
+         */
+        bool blank = true;
+        /**
+         * The line without leading and trailing spaces is [begin, end).
+         */
+        size_t begin = 0;
+        size_t end = 0;
+        /**
+         * The first space of the line.
+         */
+        size_t space = npos;
+        /**
+         * The space after the mnemonic (the first one inside the trimmed line).
+         */
+        size_t nameEnd = npos;
+        /**
+         * The first comma and space of the operands.
+         */
+        Split split;
+
+        [[nodiscard]] auto trimmed() const -> std::string_view { return text.substr(begin, end - begin); }
+
+        /**
+         * @return The label name, mnemonic or directive (the trimmed line up to its first space).
+         */
+        [[nodiscard]] auto name() const -> std::string_view {
+            return nameEnd == npos ? trimmed() : text.substr(begin, nameEnd - begin);
+        }
+
+        /**
+         * @return Everything after the mnemonic in the trimmed line (the whole trimmed line without a space).
+         */
+        [[nodiscard]] auto operands() const -> std::string_view {
+            return nameEnd == npos ? trimmed() : text.substr(nameEnd + 1, end - nameEnd - 1);
+        }
+
+        /**
+         * @return Everything after the first space of the line, without trailing spaces.
+         */
+        [[nodiscard]] auto operand() const -> std::string_view {
+            if (space == npos) return {};
+            // Nothing but spaces after it: kept as is
+            return end > space + 1 ? text.substr(space + 1, end - space - 1) : text.substr(space + 1);
+        }
+    };
+
+    /**
+     * Splits text into tokenized lines, with the same line semantics as io::LineReader.
+     */
+    class Tokenizer {
+    public:
+        explicit Tokenizer(std::string_view text) : text_(text) {}
+
+        /**
+         * Reads the next line.
+         *
+         * @param line Receives the line and its spans.
+         * @return False once the end of the text has been reached.
+         */
+        [[nodiscard]] auto next(Line& line) -> bool {
+            if (pos_ >= text_.size()) return false;
+
+            uint64_t valid = 0;
+            Masks masks = window(pos_, valid);
+            uint64_t newline = masks.newline & valid;
+            if (newline != 0 || valid != ~uint64_t{0}) {
+                // The whole line is in the window
+                auto length = static_cast<size_t>(newline != 0 ? __builtin_ctzll(newline) : __builtin_popcountll(valid));
+                resolve(line, text_.substr(pos_, length), masks, length == 0 ? 0 : ~uint64_t{0} >> (64 - length));
+                pos_ += length + 1;
+                return true;
+            }
+
+            // Longer lines are resolved one window at a time
+            size_t start = pos_;
+            State state;
+            for (;; pos_ += BLOCK) {
+                masks = window(pos_, valid);
+                newline = masks.newline & valid;
+                if (newline != 0) valid &= (uint64_t{1} << __builtin_ctzll(newline)) - 1;
+                state.add(masks, valid, pos_ - start);
+
+                if (newline != 0 || valid != ~uint64_t{0}) {
+                    pos_ += static_cast<size_t>(newline != 0 ? __builtin_ctzll(newline) : __builtin_popcountll(valid));
+                    state.finish(line, text_.substr(start, pos_ - start));
+                    ++pos_;
+                    return true;
+                }
+            }
+        }
+
+    private:
+        /**
+         * Spans resolved so far; each one only depends on those found before it.
+         */
+        struct State {
+            bool blank = true;
+            size_t begin = npos;
+            size_t last = npos;
+            size_t space = npos;
+            size_t nameSpace = npos; // first space after begin
+            size_t comma = npos;     // first comma after begin
+            size_t operandComma = npos;
+            size_t operandSpace = npos;
+
+            static auto first(uint64_t mask, size_t base) -> size_t {
+                return mask == 0 ? npos : base + static_cast<size_t>(__builtin_ctzll(mask));
+            }
+
+            static auto after(size_t position, size_t base) -> uint64_t {
+                return detail::from(static_cast<int64_t>(position) - static_cast<int64_t>(base));
+            }
+
+            void add(const Masks& masks, uint64_t valid, size_t base) {
+                uint64_t spaces = masks.space & valid;
+                uint64_t other = ~masks.space & valid;
+                blank = blank && (masks.blank & valid) == valid;
+
+                if (space == npos) space = first(spaces, base);
+                if (other != 0) last = base + 63 - static_cast<size_t>(__builtin_clzll(other));
+                if (begin == npos) begin = first(other, base);
+                if (begin == npos) return;
+
+                uint64_t commas = masks.comma & valid;
+                if (nameSpace == npos) nameSpace = first(spaces & after(begin, base), base);
+                if (comma == npos) comma = first(commas & after(begin, base), base);
+                if (nameSpace == npos) return;
+
+                if (operandComma == npos) operandComma = first(commas & after(nameSpace + 1, base), base);
+                if (operandSpace == npos) operandSpace = first(spaces & after(nameSpace + 1, base), base);
+            }
+
+            void finish(Line& line, std::string_view text) const {
+                line = Line();
+                line.text = text;
+                line.blank = blank;
+                line.space = space;
+                if (begin == npos) {
+                    // Only spaces (or nothing): trimming leaves the line as is
+                    line.end = text.size();
+                    return;
+                }
+
+                line.begin = begin;
+                line.end = last + 1;
+                if (nameSpace != npos && nameSpace < line.end) {
+                    line.nameEnd = nameSpace;
+                    size_t operands = nameSpace + 1;
+                    if (operandComma != npos) line.split.comma = operandComma - operands;
+                    if (operandSpace != npos && operandSpace < line.end) line.split.space = operandSpace - operands;
+                } else if (comma != npos) {
+                    line.split.comma = comma - begin;
+                }
+            }
+        };
+
+        /**
+         * Resolves a line of at most 64 bytes straight from its masks.
+         */
+        static void resolve(Line& line, std::string_view text, const Masks& masks, uint64_t valid) {
+            line = Line();
+            line.text = text;
+            line.blank = (masks.blank & valid) == valid;
+
+            uint64_t spaces = masks.space & valid;
+            uint64_t other = ~masks.space & valid;
+            line.space = spaces == 0 ? npos : static_cast<size_t>(__builtin_ctzll(spaces));
+            if (other == 0) {
+                line.end = text.size();
+                return;
+            }
+
+            line.begin = static_cast<size_t>(__builtin_ctzll(other));
+            line.end = static_cast<size_t>(64 - __builtin_clzll(other));
+            uint64_t inside = detail::from(static_cast<int64_t>(line.begin)) & ~detail::from(static_cast<int64_t>(line.end));
+            uint64_t names = spaces & inside;
+            if (names == 0) {
+                uint64_t commas = masks.comma & inside;
+                if (commas != 0) line.split.comma = static_cast<size_t>(__builtin_ctzll(commas)) - line.begin;
+                return;
+            }
+
+            line.nameEnd = static_cast<size_t>(__builtin_ctzll(names));
+            size_t operands = line.nameEnd + 1;
+            uint64_t rest = inside & detail::from(static_cast<int64_t>(operands));
+            uint64_t commas = masks.comma & rest;
+            uint64_t gaps = spaces & rest;
+            if (commas != 0) line.split.comma = static_cast<size_t>(__builtin_ctzll(commas)) - operands;
+            if (gaps != 0) line.split.space = static_cast<size_t>(__builtin_ctzll(gaps)) - operands;
+        }
+
+        /**
+         * @return The masks of the 64 bytes at `pos`; `valid` marks those inside the text.
+         */
+        auto window(size_t pos, uint64_t& valid) -> Masks {
+            // Blocks are classified once, on a fixed grid, and shared by the lines they hold
+            size_t base = pos - pos % BLOCK;
+            if (base != loaded_) {
+                if (base == loaded_ + BLOCK) {
+                    blocks_[0] = blocks_[1];
+                    valid_[0] = valid_[1];
+                } else {
+                    load(0, base);
+                }
+                load(1, base + BLOCK);
+                loaded_ = base;
+            }
+
+            size_t offset = pos - base;
+            if (offset == 0) {
+                valid = valid_[0];
+                return blocks_[0];
+            }
+            auto join = [offset](uint64_t low, uint64_t high) { return (low >> offset) | (high << (BLOCK - offset)); };
+            valid = join(valid_[0], valid_[1]);
+            const Masks& low = blocks_[0];
+            const Masks& high = blocks_[1];
+            return {join(low.newline, high.newline), join(low.space, high.space), join(low.blank, high.blank), join(low.comma, high.comma)};
+        }
+
+        void load(size_t slot, size_t base) {
+            size_t left = base < text_.size() ? text_.size() - base : 0;
+            if (left >= BLOCK) {
+                blocks_[slot] = CLASSIFY(text_.data() + base);
+                valid_[slot] = ~uint64_t{0};
+            } else {
+                // Never read past the text: classify a padded copy of the tail
+                alignas(BLOCK) std::array<char, BLOCK> tail {};
+                if (left != 0) std::memcpy(tail.data(), text_.data() + base, left);
+                blocks_[slot] = left == 0 ? Masks() : CLASSIFY(tail.data());
+                valid_[slot] = (uint64_t{1} << left) - 1;
+            }
+        }
+
+        std::string_view text_;
+        size_t pos_ = 0;
+        size_t loaded_ = npos;
+        std::array<Masks, 2> blocks_ {};
+        std::array<uint64_t, 2> valid_ {};
+    };
+
+    /**
+     * @return The spans of a single line.
+     */
+    [[nodiscard]] inline auto tokenize(std::string_view text) -> Line {
+        Line line;
+        if (!Tokenizer(text).next(line)) line.text = text;
+        return line;
+    }
+} // namespace scan
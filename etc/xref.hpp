@@ -0,0 +1,265 @@
+#pragma once
+
+#include <analysis.hpp>
+#include <intern.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+/**
+ * A namespace for the symbol table and cross-reference index.
+ */
+namespace xref {
+    /**
+     * Enumerates how a line uses a symbol.
+     */
+    enum Use : uint8_t {
+        DEFINITION,
+        /**
+         * `.globl`, `.global` or `global`.
+         */
+        GLOBAL,
+        CALL,
+        JMP,
+        JE,
+        JNE,
+        /**
+         * Not a symbol use; only recorded for the control-flow graph.
+         */
+        RET
+    };
+
+    inline constexpr std::array<std::string_view, RET + 1> USE_NAMES = {"definition", "global", "call", "jmp", "je", "jne", "ret"};
+
+    /**
+     * A use of a symbol. The name points into the analyzed text.
+     */
+    struct Event {
+        std::string_view name;
+        uint64_t line = 0; // 0-based, relative to the chunk
+        Use use = DEFINITION;
+    };
+
+    namespace detail {
+        [[nodiscard]] inline auto strip(std::string_view text) -> std::string_view {
+            size_t first = text.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos) return {};
+            return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+        }
+    } // namespace detail
+
+    /**
+     * Appends the symbol uses of an analyzed line to `events`.
+     */
+    inline void collect(const analysis::Record& record, uint64_t line, std::vector<Event>& events) {
+        Use use = DEFINITION;
+        switch (record.kind) {
+        case analysis::LABEL:
+            events.push_back({record.name, line, DEFINITION});
+            return;
+        case analysis::DIRECTIVE:
+            if (record.directive != directives::GLOBL && record.directive != directives::GLOBAL) return;
+            use = GLOBAL;
+            break;
+        case analysis::INSTRUCTION:
+            switch (record.opcode) {
+            case opcodes::GLOBAL: use = GLOBAL; break;
+            case opcodes::CALL: use = CALL; break;
+            case opcodes::JMP: use = JMP; break;
+            case opcodes::JE: use = JE; break;
+            case opcodes::JNE: use = JNE; break;
+            case opcodes::RET:
+                events.push_back({{}, line, RET});
+                return;
+            default: return;
+            }
+            break;
+        default:
+            return;
+        }
+
+        // Branch targets a RISC backend split out are the last operand; a register
+        // target (an indirect branch) still ends a basic block
+        if (use != GLOBAL && record.argCount > 0) {
+            const analysis::Operand& target = record.args[record.argCount - 1];
+            events.push_back({target.kind == analysis::REGISTER ? std::string_view() : target.text, line, use});
+            return;
+        }
+
+        // Declarations may list several symbols
+        std::string_view operands = record.operands;
+        while (!operands.empty()) {
+            size_t comma = use == GLOBAL ? operands.find(',') : std::string_view::npos;
+            std::string_view name = detail::strip(operands.substr(0, comma));
+            if (!name.empty()) events.push_back({name, line, use});
+            if (comma == std::string_view::npos) break;
+            operands.remove_prefix(comma + 1);
+        }
+    }
+
+    /**
+     * The symbols of a file and every line that uses them.
+     *
+     * Names are interned, so a symbol is one flat hash probe away; references are
+     * kept in one array and grouped per symbol only when the index is written.
+     */
+    class Index {
+    public:
+        Index() = default;
+        Index(const Index&) = delete;
+        auto operator=(const Index&) -> Index& = delete;
+
+        /**
+         * Adds the uses found in a chunk.
+         *
+         * @param events The chunk's uses, in line order.
+         * @param firstLine The 1-based line number of the chunk's first line.
+         */
+        void add(const std::vector<Event>& events, uint64_t firstLine) {
+            for (const Event& event : events) {
+                if (event.use == RET || event.name.empty()) continue;
+                intern::Id id = symbols_.intern(event.name).first;
+                Symbol& symbol = symbols_.value(id);
+                uint64_t line = firstLine + event.line;
+                if (event.use == DEFINITION) {
+                    if (symbol.definition != 0) ++symbol.redefinitions;
+                    // the file's own definition wins over an included one
+                    if (symbol.definition == 0 || symbol.file != 0) {
+                        symbol.definition = line;
+                        symbol.file = 0;
+                    }
+                    continue;
+                }
+                if (event.use == GLOBAL) symbol.global = true;
+                references_.push_back({id, line, event.use});
+            }
+        }
+
+        /**
+         * Adds the definitions of an included file, before or after the file's own uses.
+         * A symbol the file itself defines keeps that definition.
+         *
+         * @param events The uses found in the included file.
+         * @param file Its path, reported with its definitions.
+         */
+        void include(const std::vector<Event>& events, std::string_view file) {
+            files_.push_back(arena_.copy(file));
+            auto number = static_cast<uint32_t>(files_.size());
+            for (const Event& event : events) {
+                if (event.use != DEFINITION) continue;
+                Symbol& symbol = symbols_.value(symbols_.intern(event.name).first);
+                if (symbol.definition != 0) {
+                    ++symbol.redefinitions;
+                    continue;
+                }
+                symbol.definition = event.line + 1;
+                symbol.file = number;
+            }
+        }
+
+        /**
+         * @return The number of symbols.
+         */
+        [[nodiscard]] auto size() const -> size_t { return symbols_.size(); }
+
+        /**
+         * @return Whether `name` is defined in the file.
+         */
+        [[nodiscard]] auto defined(std::string_view name) const -> bool {
+            intern::Id id = symbols_.find(name);
+            return id != intern::NONE && symbols_.value(id).definition != 0;
+        }
+
+        /**
+         * Renders the index as assembly comments: definitions, references and undefined symbols.
+         */
+        void write(std::string& out) const {
+            // Group the references per symbol (counting sort, stable in line order)
+            std::vector<size_t> start(symbols_.size() + 1, 0);
+            for (const Reference& reference : references_) ++start[reference.symbol + 1];
+            for (size_t id = 0; id < symbols_.size(); ++id) start[id + 1] += start[id];
+            std::vector<const Reference*> grouped(references_.size());
+            std::vector<size_t> next(start.begin(), start.end() - 1);
+            for (const Reference& reference : references_) grouped[next[reference.symbol]++] = &reference;
+
+            std::vector<intern::Id> defined;
+            std::vector<intern::Id> undefined;
+            for (intern::Id id = 0; id < symbols_.size(); ++id)
+                (symbols_.value(id).definition != 0 ? defined : undefined).push_back(id);
+            std::sort(defined.begin(), defined.end(), [this](intern::Id a, intern::Id b) {
+                const Symbol& first = symbols_.value(a);
+                const Symbol& second = symbols_.value(b);
+                return first.file != second.file ? first.file < second.file : first.definition < second.definition;
+            });
+
+            out += "; CROSS-REFERENCE:\n";
+            out += "; \tSymbols: " + std::to_string(symbols_.size()) + " (" + std::to_string(defined.size()) + " defined, "
+                + std::to_string(undefined.size()) + " undefined)\n";
+            out += "; \tReferences: " + std::to_string(references_.size()) + "\n;\n";
+
+            out += "; DEFINITIONS:\n";
+            for (intern::Id id : defined) {
+                const Symbol& symbol = symbols_.value(id);
+                out += "; \t";
+                out += symbols_.text(id);
+                out += '\t';
+                if (symbol.file != 0) {
+                    out += files_[symbol.file - 1];
+                    out += ':';
+                    out += std::to_string(symbol.definition);
+                } else {
+                    out += "line " + std::to_string(symbol.definition);
+                }
+                if (symbol.global) out += " global";
+                if (symbol.redefinitions != 0) out += " (redefined " + std::to_string(symbol.redefinitions) + "x)";
+                out += '\n';
+            }
+
+            out += ";\n; REFERENCES:\n";
+            for (intern::Id id = 0; id < symbols_.size(); ++id) {
+                if (start[id] == start[id + 1]) continue;
+                appendReferences(out, id, grouped, start);
+            }
+
+            out += ";\n; UNDEFINED:\n";
+            for (intern::Id id : undefined) appendReferences(out, id, grouped, start);
+        }
+
+    private:
+        struct Symbol {
+            uint64_t definition = 0; // 1-based line, 0 if not defined
+            uint32_t redefinitions = 0;
+            uint32_t file = 0; // 1-based index into files_ for definitions in an included file, 0 for the file itself
+            bool global = false;
+        };
+
+        struct Reference {
+            intern::Id symbol = intern::NONE;
+            uint64_t line = 0;
+            Use use = CALL;
+        };
+
+        void appendReferences(std::string& out, intern::Id id, const std::vector<const Reference*>& grouped,
+                              const std::vector<size_t>& start) const {
+            out += "; \t";
+            out += symbols_.text(id);
+            out += '\t';
+            for (size_t i = start[id]; i < start[id + 1]; ++i) {
+                if (i != start[id]) out += ", ";
+                out += USE_NAMES[grouped[i]->use];
+                out += ' ';
+                out += std::to_string(grouped[i]->line);
+            }
+            out += '\n';
+        }
+
+        intern::Arena arena_;
+        intern::Table<Symbol> symbols_ {arena_};
+        std::vector<Reference> references_;
+        std::vector<std::string_view> files_; // the included files, in the arena
+    };
+} // namespace xref
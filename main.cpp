@@ -5,14 +5,162 @@ const static std::unordered_set<std::string> forbidden = {
     "COM5", "COM6", "COM7", "COM8", "COM9", "LPT1", "LPT2", "LPT3",
     "LPT4", "LPT5", "LPT6", "LPT7", "LPT8", "LPT9"};
 
-const static std::unordered_set<std::string> supportedExtensions = { // no lst
+const static std::unordered_set<std::string> supportedExtensions = { // no lst; also compressed (see compression::EXTENSIONS)
     "asm", "s", "hla", "inc", "palx", "mid"
 };
 
-const static std::string VERSION = "0.1.0";
-const static std::string filename;
+const static std::string USAGE =
+    "Usage: asm-analyze [options] [path...]\n"
+    "\n"
+    "Analyzes assembly files (also .gz/.zst compressed), directories (recursively) or stdin ('-').\n"
+    "Without a path, the path is read from an interactive prompt.\n"
+    "\n"
+    "Options:\n"
+    "  -o, --output FILE  Write the analyzed text to FILE ('-' for stdout, compressed if it ends in .gz/.zst); single input only\n"
+    "  -j, --jobs N       Number of worker threads (default: hardware concurrency)\n"
+    "      --cache DIR    Reuse the outputs of unchanged inputs from (and store new ones in) DIR\n"
+    "      --stats[=FILE] Print run statistics as JSON (to FILE, or stdout unless it carries the output)\n"
+    "      --xref         Also write a symbol cross-reference (OUTPUT.xref, appended when writing to stdout)\n"
+    "      --includes     Follow .include/%include in the cross-reference; each header is analyzed once per run\n"
+    "      --incremental  Only re-analyze the parts of a file that changed since the last run (keeps OUTPUT.idx)\n"
+    "      --cfg FORMAT   Also write the control-flow graph, as 'dot' (OUTPUT.dot) or 'bin' (OUTPUT.cfg)\n"
+    "      --format FORMAT Write 'text' (default) or 'columnar' (binary, NAME_analyzed.col) output\n"
+    "      --compress FORMAT Compress the text output as 'gz' (NAME_analyzed.s.gz) or 'zst'\n"
+    "      --convert FILE Convert a columnar FILE back to text; the source is the path given, or the recorded one\n"
+    "      --serve SOCKET Stay resident and analyze the requests of asm-analyze-client on a Unix socket\n"
+    "      --no-pause     Don't wait for a key press before exiting\n"
+    "  -h, --help         Show this help\n";
+
+int main(int argc, char* argv[]) {
+    unsigned jobs = parallel::defaultJobs();
+    std::vector<std::string> inputs;
+    std::string output;
+    std::string cacheDirectory;
+    std::string statsFile;
+    bool crossReference = false;
+    std::string_view graphFormat;
+    std::string_view outputFormat;
+    std::string_view compressFormat;
+    std::string convert;
+    std::string socketPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        std::string_view value;
+        if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+            value = argv[++i];
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            value = arg.substr(7);
+        } else if ((arg == "--output" || arg == "-o") && i + 1 < argc) {
+            output = argv[++i];
+            continue;
+        } else if (arg.rfind("--output=", 0) == 0) {
+            output = arg.substr(9);
+            continue;
+        } else if ((arg == "--cache") && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+            continue;
+        } else if (arg.rfind("--cache=", 0) == 0) {
+            cacheDirectory = arg.substr(8);
+            continue;
+        } else if (arg == "--stats") {
+            stats::enabled = true;
+            continue;
+        } else if (arg.rfind("--stats=", 0) == 0) {
+            stats::enabled = true;
+            statsFile = arg.substr(8);
+            continue;
+        } else if (arg == "--xref") {
+            crossReference = true;
+            continue;
+        } else if (arg == "--includes") {
+            includes::follow = true;
+            continue;
+        } else if (arg == "--incremental") {
+            incremental::enabled = true;
+            continue;
+        } else if ((arg == "--cfg") && i + 1 < argc) {
+            graphFormat = argv[++i];
+            continue;
+        } else if (arg.rfind("--cfg=", 0) == 0) {
+            graphFormat = arg.substr(6);
+            continue;
+        } else if ((arg == "--format") && i + 1 < argc) {
+            outputFormat = argv[++i];
+            continue;
+        } else if (arg.rfind("--format=", 0) == 0) {
+            outputFormat = arg.substr(9);
+            continue;
+        } else if ((arg == "--compress") && i + 1 < argc) {
+            compressFormat = argv[++i];
+            continue;
+        } else if (arg.rfind("--compress=", 0) == 0) {
+            compressFormat = arg.substr(11);
+            continue;
+        } else if ((arg == "--convert") && i + 1 < argc) {
+            convert = argv[++i];
+            continue;
+        } else if (arg.rfind("--convert=", 0) == 0) {
+            convert = arg.substr(10);
+            continue;
+        } else if ((arg == "--serve") && i + 1 < argc) {
+            socketPath = argv[++i];
+            continue;
+        } else if (arg.rfind("--serve=", 0) == 0) {
+            socketPath = arg.substr(8);
+            continue;
+        } else if (arg == "--no-pause") {
+            dbg::Misc::pauseOnExit = false;
+            continue;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << USAGE;
+            return 0;
+        } else if (arg == "-" || arg[0] != '-') {
+            inputs.emplace_back(arg);
+            continue;
+        } else {
+            dbg::Misc::fexit("Unknown argument: " + std::string(arg));
+        }
+
+        unsigned n = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), n);
+        if (ec != std::errc() || end != value.data() + value.size() || n == 0)
+            dbg::Misc::fexit("Invalid --jobs value: " + std::string(value));
+        jobs = n;
+    }
+
+    // Keep stdout clean when it carries the analyzed text
+    bool streaming = std::find(inputs.begin(), inputs.end(), "-") != inputs.end();
+    bool stdoutTaken = output == "-" || ((streaming || !convert.empty()) && output.empty());
+    if (stdoutTaken) dbg::Debugger::output = &std::cerr;
+    if (streaming || stdoutTaken) dbg::Misc::pauseOnExit = false;
+
+    cfg::Format graph = cfg::NONE;
+    if (graphFormat == "dot") graph = cfg::DOT;
+    else if (graphFormat == "bin") graph = cfg::BINARY;
+    else if (!graphFormat.empty()) dbg::Misc::fexit("Invalid --cfg format: " + std::string(graphFormat));
+    if (graph != cfg::NONE && stdoutTaken)
+        dbg::Misc::fexit("--cfg needs an output file");
+    if (includes::follow && !crossReference)
+        dbg::Misc::fexit("--includes needs --xref");
+
+    bool columnar = outputFormat == "columnar";
+    if (!columnar && !outputFormat.empty() && outputFormat != "text")
+        dbg::Misc::fexit("Invalid --format: " + std::string(outputFormat));
+    if (columnar && streaming)
+        dbg::Misc::fexit("--format columnar needs a file input");
+    if (columnar && crossReference && stdoutTaken)
+        dbg::Misc::fexit("--xref with --format columnar needs an output file");
+    if (incremental::enabled && (crossReference || graph != cfg::NONE || columnar))
+        dbg::Misc::fexit("--incremental only applies to the text output, without --xref or --cfg");
+
+    if (!compressFormat.empty() && !compression::parse(compressFormat, compression::output))
+        dbg::Misc::fexit("Invalid --compress format: " + std::string(compressFormat));
+    compression::Codec outputCodec = output.empty() || output == "-" ? compression::output : compression::codecOf(output);
+    if (!compression::available(outputCodec))
+        dbg::Misc::fexit("asm-analyze was built without " + std::string(compression::NAMES[outputCodec]) + " support");
+    if (outputCodec != compression::NONE && (columnar || incremental::enabled))
+        dbg::Misc::fexit("Compressed output only applies to the text output, without --incremental");
 
-int main() {
 #if defined(_WIN32) || defined(_WIN64)
     // Prepare console
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -21,395 +169,338 @@ int main() {
     dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
     SetConsoleMode(hConsole, dwMode);
 #endif
-    std::cout << "Enter assembly file/directory (e.g. file.asm or /path/to/file.asm): ";
-    std::string filename;
-    std::getline(std::cin, filename);
-    if (filename.empty() || filename.find_first_not_of(" \t\r\f\v") == std::string::npos)
-        dbg::Misc::fexit("Detected empty input");
-
-    // Convert to uppercase for path checking
-    std::string ufilename = filename;
-    std::transform(ufilename.begin(), ufilename.end(), ufilename.begin(), ::toupper);
-
-    size_t pos = 0;
-    while ((pos = ufilename.find('/')) != std::string::npos) {
-        std::string part = ufilename.substr(0, pos);
-        if (forbidden.count(part) > 0)
-            dbg::Misc::fexit("Detected forbidden keyword");
-        ufilename.erase(0, pos + 1);
+    std::unique_ptr<cache::Store> store;
+    if (!cacheDirectory.empty()) {
+        store = std::make_unique<cache::Store>(cacheDirectory, core::VERSION);
+        if (!*store) dbg::Misc::fexit("Cannot use cache directory " + cacheDirectory);
     }
 
-    // Remove the file extension & check whether file type is supported or not
-    size_t dotPos = filename.find_last_of('.');
-    std::string extension;
-    if (dotPos != std::string::npos) {
-        extension = filename.substr(dotPos + 1);
-        for (char& c : extension) c = static_cast<char>(tolower(c));
-        if (supportedExtensions.count(extension) == 0U)
-            dbg::Misc::fexit("Detected forbidden keyword");
-        ufilename.erase(dotPos);
-    }
-
-    // Check the remaining part of the file name
-    if (forbidden.count(ufilename) > 0) {
-        dbg::Misc::fexit("Detected forbidden keyword");
+    // The daemon answers requests until it is interrupted
+    if (!socketPath.empty()) {
+        if (!inputs.empty() || !output.empty() || !convert.empty())
+            dbg::Misc::fexit("--serve takes no inputs; send them with asm-analyze-client");
+        dbg::Misc::pauseOnExit = false;
+        auto runBegin = std::chrono::steady_clock::now();
+        uint64_t runTicks = stats::now();
+        try {
+            serveRequests(socketPath, jobs, store.get(), crossReference, graph, columnar);
+        } catch (const std::exception& e) {
+            dbg::Misc::fexit(e.what());
+        }
+        if (stats::enabled) {
+            dbg::Debugger::flush();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runBegin).count();
+            std::cout << stats::json(core::VERSION, seconds, stats::now() - runTicks) << std::flush;
+        }
+        return 0;
     }
 
-    auto begin = std::chrono::high_resolution_clock::now();
-
-    std::ifstream originalFile(filename);
-    if (!originalFile) {
-        dbg::Misc::fexit("File not found");
+    if (!convert.empty()) {
+        if (inputs.size() > 1) dbg::Misc::fexit("--convert takes at most one source");
+        try {
+            auto begin = std::chrono::steady_clock::now();
+            uint64_t lines = convertColumnar(convert, inputs.empty() ? "" : inputs[0], output.empty() ? "-" : output);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            dbg::Macros::info("Successfully converted " + convert + " (" + std::to_string(lines) + " lines) in " + std::to_string(seconds) + "s");
+        } catch (const std::exception& e) {
+            dbg::Misc::fexit(e.what());
+        }
+        dbg::Misc::pause();
+        return 0;
     }
 
-    std::string nfilename = filename;
-    if (dotPos != std::string::npos) {
-        nfilename.insert(dotPos, "_analyzed");
-    } else {
-        nfilename += "_analyzed";
+    if (inputs.empty()) {
+        std::cout << "Enter assembly file/directory (e.g. file.asm or /path/to/file.asm): ";
+        std::string filename;
+        std::getline(std::cin, filename);
+        if (filename.empty() || filename.find_first_not_of(" \t\r\f\v") == std::string::npos)
+            dbg::Misc::fexit("Detected empty input");
+        inputs.push_back(filename);
     }
 
-    std::ofstream newFile(nfilename);
-    if (!newFile)
-        dbg::Misc::fexit("Cannot open " + nfilename + ", exiting.");
-
-    std::string architecture = getArchitecture(filename);
-
-    newFile << "; INFORMATION:" << '\n';
-    newFile << "; \tAssembly Analyzer Version: " << VERSION << '\n';
-    auto now = std::chrono::system_clock::now();
-    std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
-    struct tm localTime {};
-#if defined(_WIN32) || defined (_WIN64)
-    localtime_s(&localTime, &currentTime);
-#else
-    localtime_r(&currentTime, &localTime);
-#endif
-    newFile << "; \tAnalyzed on: " << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S") << '\n';
-    newFile << "; \tInstruction Set Architecture: " << architecture << '\n' << '\n';
+    if (!output.empty() && inputs.size() > 1)
+        dbg::Misc::fexit("--output needs a single input");
+
+    std::unique_ptr<parallel::ThreadPool> pool;
+    if (jobs > 1) pool = std::make_unique<parallel::ThreadPool>(jobs);
+
+    auto runBegin = std::chrono::steady_clock::now();
+    uint64_t runTicks = stats::now();
+    stats::Totals& run = stats::totals();
+    for (const std::string& filename : inputs) {
+        auto begin = std::chrono::steady_clock::now();
+        uint64_t lines = run.lines;
+
+        std::error_code ec;
+        if (filename == "-") {
+            // Bounded-memory streaming: the output goes out block by block
+            io::OutputFile out(output.empty() ? "-" : output);
+            if (!out) dbg::Misc::fexit("Cannot open " + output);
+            try {
+                std::unique_ptr<xref::Index> index;
+                if (crossReference) index = std::make_unique<xref::Index>();
+                std::unique_ptr<cfg::Builder> builder;
+                if (graph != cfg::NONE) builder = std::make_unique<cfg::Builder>();
+                io::StreamReader in(std::cin);
+                analyzeStream(in, out, pool.get(), index.get(), builder.get(), outputCodec);
+                ++run.files;
+                if (index != nullptr) writeAppendix(out, *index, outputCodec);
+                out.close();
+                if (builder != nullptr) {
+                    std::string sidecar = output + std::string(cfg::EXTENSIONS[graph]);
+                    io::OutputFile file(sidecar);
+                    if (!file) dbg::Misc::fexit("Cannot open " + sidecar);
+                    std::string text;
+                    builder->write(graph, text);
+                    file.write(std::move(text));
+                    file.close();
+                }
+            } catch (const std::exception& e) {
+                dbg::Misc::fexit(e.what());
+            }
+        } else if (std::filesystem::is_directory(filename, ec)) {
+            if (!output.empty())
+                dbg::Misc::fexit("--output cannot be used with a directory");
+            analyzeDirectory(filename, jobs, store.get(), crossReference, graph, columnar);
+            continue;
+        } else {
+            checkPath(filename);
+            try {
+                analyzeFile(filename, pool.get(), output, store.get(), crossReference, graph, columnar);
+            } catch (const std::exception& e) {
+                dbg::Misc::fexit(e.what());
+            }
+        }
 
-    std::string line;
-    while (getline(originalFile, line)) {
-        std::string comment = analyzeLine(line);
-        newFile << line << (comment.empty() ? "\n" : "\t\t; " + comment + "\n");
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        dbg::Macros::info("Successfully analyzed " + (filename == "-" ? std::string("stdin") : filename) + " (" + std::to_string(run.lines - lines) + " lines) in " + std::to_string(seconds) + "s");
     }
 
-    originalFile.close();
-    newFile.close();
-
-    auto delta = std::chrono::high_resolution_clock::now() - begin;
-    dbg::Macros::info("Successfully analyzed " + filename + " in " + std::to_string(std::chrono::duration<double>(delta).count()) + "s");
+    if (stats::enabled) {
+        dbg::Debugger::flush(); // the report follows the log
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runBegin).count();
+        std::string report = stats::json(core::VERSION, seconds, stats::now() - runTicks);
+        if (!statsFile.empty()) {
+            std::ofstream out(statsFile, std::ios::binary);
+            if (!out.write(report.data(), static_cast<std::streamsize>(report.size())))
+                dbg::Macros::warn("Cannot write statistics to " + statsFile);
+        } else {
+            (stdoutTaken ? std::cerr : std::cout) << report << std::flush;
+        }
+    }
     dbg::Misc::pause();
 
     return 0;
 }
 
-[[nodiscard]] auto isDirective(const std::string& opcode) -> bool {
-    return !opcode.empty() && opcode[0] == '.';
+void checkPath(const std::string& filename) {
+    if (!isAllowedPath(filename))
+        dbg::Misc::fexit("Detected forbidden keyword");
 }
 
-[[nodiscard]] auto isMemoryAddressingMode(const std::string& operand) -> bool {
-    return !operand.empty() && operand[0] == '[' && operand.back() == ']' && operand.find('%') != std::string::npos;
-}
+auto isAllowedPath(const std::string& filename) -> bool {
+    // Convert to uppercase for path checking
+    std::string ufilename = filename;
+    std::transform(ufilename.begin(), ufilename.end(), ufilename.begin(), ::toupper);
 
-[[nodiscard]] auto getOperand(const std::string& line) -> std::string {
-    size_t wPos = line.find(' ');
-    if (wPos == std::string::npos) return "";
+    size_t pos = 0;
+    while ((pos = ufilename.find('/')) != std::string::npos) {
+        std::string part = ufilename.substr(0, pos);
+        if (forbidden.count(part) > 0) return false;
+        ufilename.erase(0, pos + 1);
+    }
 
-    std::string operand = line.substr(wPos + 1);
-    size_t trailingWPos = operand.find_last_not_of(' ');
-    if (trailingWPos != std::string::npos)
-        operand = operand.substr(0, trailingWPos + 1);
+    // Remove the file extension & check whether file type is supported or not (under a compressed one)
+    ufilename.erase(compression::strip(ufilename).size());
+    size_t dotPos = ufilename.find_last_of('.');
+    if (dotPos != std::string::npos) {
+        std::string extension = ufilename.substr(dotPos + 1);
+        for (char& c : extension) c = static_cast<char>(tolower(c));
+        if (supportedExtensions.count(extension) == 0U) return false;
+        ufilename.erase(dotPos);
+    }
 
-    return operand;
+    // Check the remaining part of the file name
+    return forbidden.count(ufilename) == 0;
 }
 
-[[nodiscard]] auto analyzeDirective(const std::string& opcode, const std::string& operand) -> std::string {
-    if (opcode == ".string") {
-        std::string lineValue = trim(operand).substr(8);
-        return "string constant " + lineValue + " declared";
-    } if (opcode == ".data") {
-        return "Data section declared";
-    } if (opcode == ".bss") {
-        return "BSS (uninitialized data) section declared";
-    } if (opcode == ".text") {
-        return "Text (code) section declared";
-    } if (opcode == ".globl" || opcode == ".global") {
-        return "Global symbol " + operand + " declared";
-    } if (opcode == ".align") {
-        return "Align to " + operand + " bytes";
-    } if (opcode == ".byte") {
-        return "Byte value " + operand + " declared";
-    } if (opcode == ".word") {
-        return "Word value " + operand + " declared";
-    } if (opcode == ".dword") {
-        return "Double word value " + operand + " declared";
-    } if (opcode == ".quad") {
-        return "Quad word (64-bit) value " + operand + " declared";
-    } if (opcode == ".section") {
-        return "Section " + operand + " declared";
-    } if (opcode == ".equ" || opcode == ".set") {
-        return "Constant " + operand + " defined";
-    } if (opcode == ".org") {
-        return "Set origin to address " + operand;
-    } if (opcode == ".reserve" || opcode == ".space") {
-        return "Reserve " + operand + " bytes";
-    } if (opcode == ".file") {
-        return "File name set to " + operand;
-    } if (opcode == ".comm") {
-        return "Common block " + operand + " declared";
-    } if (opcode == ".end") {
-        return "End of assembly";
-    } if (opcode == ".incbin") {
-        return "Include binary file " + operand;
-    }
-
-    return "Unknown directive: " + opcode;
+auto isServedPath(const std::string& filename, bool output) -> bool {
+    // The daemon acts for other processes, so unlike the command line it needs an
+    // assembly extension (or, for an output, the columnar one) on every path it touches
+    if (!isAllowedPath(filename)) return false;
+    std::string name(compression::strip(std::filesystem::path(filename).filename().string()));
+    size_t dotPos = name.find_last_of('.');
+    if (dotPos == std::string::npos) return false;
+    std::string extension = name.substr(dotPos + 1);
+    for (char& c : extension) c = static_cast<char>(tolower(c));
+    return supportedExtensions.count(extension) != 0U || (output && extension == "col");
 }
 
-[[nodiscard]] auto analyzeLine(const std::string& line) -> std::string {
-    if (line.find_first_not_of(" \t\r\n") == std::string::npos) return "";
+void analyzeDirectory(const std::string& directory, unsigned jobs, cache::Store* store, bool crossReference, cfg::Format graph, bool columnar) {
+    namespace fs = std::filesystem;
 
-    std::string trimmedLine = trim(line);
+    struct Job {
+        std::string path;
+        uintmax_t size = 0;
+    };
 
-    if (!trimmedLine.empty() && trimmedLine[trimmedLine.size() - 1] == ':')
-        return "Label: " + trimmedLine.substr(0, trimmedLine.size() - 1);
+    auto begin = std::chrono::high_resolution_clock::now();
 
-    size_t spacePos = trimmedLine.find(' ');
-    std::string opcode = trimmedLine.substr(0, spacePos);
+    // Collect the supported files, skipping the outputs of earlier runs
+    std::vector<Job> files;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+
+        // A compressed file is recognized by the name inside it
+        fs::path name(std::string(compression::strip(it->path().filename().string())));
+        std::string extension = name.extension().string();
+        if (extension.empty()) continue;
+        extension.erase(0, 1);
+        for (char& c : extension) c = static_cast<char>(tolower(c));
+        if (supportedExtensions.count(extension) == 0U) continue;
 
-    if (isInstruction(opcode)) {
-        std::string operands = trimmedLine.substr(spacePos + 1);
-        return analyzeInstruction(opcode, operands, line);
-    }
+        std::string stem = name.stem().string();
+        if (stem.size() >= 9 && stem.compare(stem.size() - 9, 9, "_analyzed") == 0) continue;
 
-    if (isDirective(opcode)) {
-        std::string operand = getOperand(line);
-        return analyzeDirective(opcode, operand);
+        uintmax_t size = it->file_size(ec);
+        files.push_back({it->path().string(), ec ? 0 : size});
     }
-
-    return "Unknown instruction";
-}
-
-[[nodiscard]] auto analyzeInstruction(const std::string& opcode, const std::string& operands, const std::string& line) -> std::string {
-    if (opcode == "global") {
-        return "Declare global symbol " + operands;
-    } if (opcode == "len") {
-        return "Calculate length of " + operands;
-    } if (opcode == "int") {
-        size_t spacePos = operands.find(' ');
-        std::string operand = operands.substr(0, spacePos);
-
-        if (operand.find("0x") == 0) {
-            return std::string("Instruction: int ") + std::string("| Interrupt: ") + operand;
+    if (ec)
+        dbg::Macros::warn("Stopped walking " + directory + ": " + ec.message());
+
+    // Largest files first, so that a huge file does not start last and run alone
+    std::sort(files.begin(), files.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+
+    size_t hitsBefore = store == nullptr ? 0 : store->hits();
+    std::atomic<size_t> analyzed = 0;
+    std::atomic<uintmax_t> bytes = 0;
+    parallel::stealingForEach(files, jobs, [&](const Job& job) {
+        try {
+            bytes += analyzeFile(job.path, nullptr, "", store, crossReference, graph, columnar);
+            ++analyzed;
+        } catch (const std::exception& e) {
+            dbg::Macros::error(e.what());
         }
-    } if (opcode == "push") {
-        std::string operand = getOperand(line);
-        return "push instruction: pushed " + operand + " into stack";
-    } if (opcode == "mov" || opcode == "movq" || opcode == "add" || opcode == "addq" || opcode == "sub" || opcode == "subq") {
-        size_t commaPos = operands.find(',');
-        if (commaPos != std::string::npos) {
-            std::string destination = operands.substr(0, commaPos);
-            std::string source = operands.substr(commaPos + 1);
-            return "Instruction: " + opcode + " | Destination: "  + \
-            analyzeOperand(destination, true) + \
-            " | Source:" + analyzeOperand(source, true);
-        }
-    } if (opcode == "jmp") {
-        std::string operand = getOperand(line);
-        return "jmp instruction: jumped to " + operand;
-    } if (opcode == "call") {
-        std::string operand = getOperand(line);
-        return "call instruction: called " + operand;
-    } if (opcode == "ret") {
-        return "ret instruction: returned from function";
-    } if (opcode == "nop") {
-        return "no operation";
-    } if (opcode == "cmp") {
-        size_t spacePos = operands.find(' ');
-        std::string destOperand = operands.substr(0, spacePos);
-        std::string srcOperand = operands.substr(spacePos + 1);
-
-        std::string dest = analyzeOperand(destOperand, true);
-        std::string src = analyzeOperand(srcOperand, true);
-
-        return "Instruction: cmp | Destination: " + dest + " | Source: " + src;
-    } if (opcode == "je") {
-        std::string operand = getOperand(line);
-        return "je instruction: jumped to " + operand + " if equal";
-    } if (opcode == "jne") {
-        std::string operand = getOperand(line);
-        return "jne instruction: jumped to " + operand + " if not equal";
-    } if (opcode == "inc") {
-        std::string operand = getOperand(line);
-        return "inc instruction: incremented " + operand;
-    } if (opcode == "dec") {
-        std::string operand = getOperand(line);
-        return "dec instruction: decremented " + operand;
-    } if (opcode == "mul") {
-        size_t spacePos = operands.find(' ');
-        std::string destOperand = operands.substr(0, spacePos);
-        std::string srcOperand = operands.substr(spacePos + 1);
-
-        std::string dest = analyzeOperand(destOperand, true);
-        std::string src = analyzeOperand(srcOperand, true);
-
-        return "Instruction: mul | Destination: " + dest + " | Source: " + src;
-    } if (opcode == "div") {
-        size_t spacePos = operands.find(' ');
-        std::string destOperand = operands.substr(0, spacePos);
-        std::string srcOperand = operands.substr(spacePos + 1);
-
-        std::string dest = analyzeOperand(destOperand, true);
-        std::string src = analyzeOperand(srcOperand, true);
-
-        return "Instruction: div | Destination: " + dest + " | Source: " + src;
-    }
-    return "Unknown instruction: " + opcode;
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+    double megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+    double rate = seconds > 0 ? 1.0 / seconds : 0.0;
+
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2) << "Analyzed " << analyzed << '/' << files.size() << " files ("
+            << megabytes << " MB) in " << seconds << "s: " << static_cast<double>(analyzed) * rate << " files/s, "
+            << megabytes * rate << " MB/s";
+    if (store != nullptr) summary << " (" << store->hits() - hitsBefore << " unchanged)";
+    dbg::Macros::info(summary.str());
 }
 
-[[nodiscard]] auto analyzeOperands(std::string& operands) -> std::string {
-    std::string operandComment;
-    std::string operands2 = operands;
-    size_t pos = 0;
 
-    while ((pos = operands2.find(' ')) != std::string::npos) {
-        std::string operand = operands2.substr(0, pos);
-        operandComment += analyzeOperand(operand) + " ";
-        operands2.erase(0, pos + 1);
+void serveRequests(const std::string& socketPath, unsigned jobs, cache::Store* store, bool crossReference, cfg::Format graph, bool columnar) {
+#if !defined(_WIN32) && !defined(_WIN64)
+    std::string error;
+    serve::Descriptor socket = serve::listen(socketPath, error);
+    if (!socket) throw std::runtime_error(error);
+    serve::stopOnSignals();
+    dbg::Macros::info("Serving on " + socketPath + " with " + std::to_string(jobs) + " workers");
+
+    // Each request is analyzed on one worker, like the files of a directory. At most
+    // BACKLOG connections per worker are taken in; the next ones wait in the kernel
+    constexpr size_t BACKLOG = 4;
+    uint64_t requests = 0;
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t open = 0; // guarded by mutex
+    {
+        parallel::ThreadPool workers(jobs);
+        while (!serve::stopping) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!finished.wait_for(lock, std::chrono::milliseconds(500), [&] { return open < BACKLOG * workers.size(); })) continue;
+            }
+            serve::Descriptor connection = serve::accept(socket, 500);
+            if (!connection) continue;
+            ++requests;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++open;
+            }
+            static_cast<void>(workers.submit([connection = std::move(connection), store, crossReference, graph, columnar, &mutex, &finished, &open]() mutable {
+                serveRequest(connection.get(), store, crossReference, graph, columnar);
+                connection.reset();
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --open;
+                }
+                finished.notify_one();
+            }));
+        }
     }
 
-    operandComment += analyzeOperand(operands);
-    return operandComment;
+    std::error_code ec;
+    std::filesystem::remove(socketPath, ec);
+    dbg::Macros::info("Stopped serving after " + std::to_string(requests) + " requests");
+#else
+    static_cast<void>(socketPath), static_cast<void>(jobs), static_cast<void>(store);
+    static_cast<void>(crossReference), static_cast<void>(graph), static_cast<void>(columnar);
+    throw std::runtime_error("--serve needs Unix domain sockets");
+#endif
 }
 
-[[nodiscard]] auto analyzeOperand(std::string& operand, bool appendType) -> std::string {
-    if (operand.empty()) return "";
-
-    for (char &c : operand) {
-        c = std::tolower(static_cast<uint8_t>(c));
-    }
-
-    // Recognized registers
-    static const std::unordered_set<std::string> registers = {
-        // okay what was i on
-        "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "rbp", "rsp", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
-        "eax", "ebx", "ecx", "edx", "esi", "edi", "ebp", "esp", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d",
-        "ax", "bx", "cx", "dx", "si", "di", "bp", "sp", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w",
-        "al", "ah", "bl", "bh", "cl", "ch", "dl", "dh", "sil", "dil", "bpl", "spl", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b",
-
-        "eip", "rip",
-        "eflags", "rflags",
-
-        "st0", "st1", "st2", "st3", "st4", "st5", "st6", "st7",
-
-        "mm0", "mm1", "mm2", "mm3", "mm4", "mm5", "mm6", "mm7",
-        "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15",
-        "ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "ymm8", "ymm9", "ymm10", "ymm11", "ymm12", "ymm13", "ymm14", "ymm15",
-        "zmm0", "zmm1", "zmm2", "zmm3", "zmm4", "zmm5", "zmm6", "zmm7", "zmm8", "zmm9", "zmm10", "zmm11", "zmm12", "zmm13", "zmm14", "zmm15", "zmm16", "zmm17", "zmm18", "zmm19", "zmm20", "zmm21", "zmm22", "zmm23", "zmm24", "zmm25", "zmm26", "zmm27", "zmm28", "zmm29", "zmm30", "zmm31",
-
-        //unsed in x86/x64>vvvvv
-        "cr0", "cr1", "cr2", "cr3", "cr4",
-        "dr0", "dr1", "dr2", "dr3", /* 2 reserved... */ "dr6", "dr7",
-        "tr3", "tr4", "tr5", "tr6", "tr7",
-
-        "gdtr", "idtr", "ldtr", "msw",
-
-        // MSRs
-        "msr_ia32_apic_base", "msr_ia32_mtrrcap", "msr_ia32_mtrr_physbase0", "msr_ia32_mtrr_physbase1", "msr_ia32_mtrr_physbase2", "msr_ia32_mtrr_physbase3", "msr_ia32_mtrr_physbase4", "msr_ia32_mtrr_physbase5", "msr_ia32_mtrr_physbase6", "msr_ia32_mtrr_physbase7", "msr_ia32_mtrr_physbase8", "msr_ia32_mtrr_physbase9", "msr_ia32_mtrr_physbase10",
-        "msr_ia32_mtrr_physmask0", "msr_ia32_mtrr_physmask1", "msr_ia32_mtrr_physmask2", "msr_ia32_mtrr_physmask3", "msr_ia32_mtrr_physmask4", "msr_ia32_mtrr_physmask5", "msr_ia32_mtrr_physmask7", "msr_ia32_mtrr_physmask8", "msr_ia32_mtrr_physmask9", "msr_ia32_mtrr_physmask10", "msr_ia32_perf_status", "msr_ia32_perf_ctl", "msr_ia32_time_stamp_counter",
-        "msr_ia32_feature_control", "msr_ia32_sysenter_cs", "msr_ia32_sysenter_esp", "msr_ia32_sysenter_eip", "msr_ia32_debugctl", "msr_ia32_sgxleaf"
-    };
-
-    // Check if the operand is a register
-    if (registers.count(operand) != 0U)
-        return appendType ? operand + " (Register)" : "Register: " + operand;
-
-    // Check for immediate values (numeric literals)
-    if (operand[0] == '$' || (std::isdigit(operand[0]) != 0) || operand == "0") {
-        std::string immediate = operand[0] == '$' ? operand.substr(1) : operand;
-        return appendType ? immediate + " (Immediate)" : "Immediate: " + immediate;
+void serveRequest(int fd, cache::Store* store, bool crossReference, cfg::Format graph, bool columnar) {
+#if !defined(_WIN32) && !defined(_WIN64)
+    constexpr size_t REQUEST_LIMIT = static_cast<size_t>(64) << 10;
+    if (!serve::trusted(fd)) {
+        static_cast<void>(serve::writeAll(fd, std::string(serve::ERROR_REPLY) + "Connections are only accepted from the daemon's user\n"));
+        return;
     }
-
-    // Check for memory addressing mode
-    if (isMemoryAddressingMode(operand)) {
-        std::string labelName = operand.substr(1, operand.size() - 2);
-        return appendType ? labelName + " (Memory Address)" : "Memory Address: " + labelName;
-    }
-
-    // Assume other operands are labels or identifiers
-    return appendType ? operand + " (Label/Identifier)" : "Label/Identifier: " + operand;
-}
-
-[[nodiscard]] auto trim(const std::string& str) -> std::string {
-    size_t first = str.find_first_not_of(' ');
-    if (std::string::npos == first) { return str; }
-
-    size_t last = str.find_last_not_of(' ');
-    return str.substr(first, (last - first + 1));
-}
-
-[[nodiscard]] auto isInstruction(const std::string& opcode) -> bool {
-    // Recognized instructions
-    const static std::vector<std::string> instructions = {
-        "int", "push", "pop", "mov", "movq", "add", "addq", "sub", "subq",
-        "jmp", "call", "ret", "cmp", "je", "jne", "inc", "dec", "mul", "div",
-        "global", "len", "nop"
-    };
-
-    return find(instructions.begin(), instructions.end(), opcode) != instructions.end();
-}
-
-[[nodiscard]] auto getArchitecture(const std::string& filename) -> std::string {
-    std::ifstream file(filename);
-    if (!file)
-        dbg::Macros::fatal("Error opening/reading " + filename + " file (is " + filename + " closed?)");
-
-    std::string architecture = "Unknown"; // default value is Unknown
-    std::string line;
-
-    while (getline(file, line)) {
-        line = trim(line);
-
-        // x86-64
-        if (line.find(".code64") != std::string::npos || line.find(".x64") != std::string::npos ||
-            line.find(".quad") != std::string::npos || line.find("BITS 64") != std::string::npos ||
-            line.find("__x86_64__") != std::string::npos || line.find("__amd64__") != std::string::npos ||
-            line.find("__aarch64__") != std::string::npos) {
-            architecture = "x86-64";
-        }
-        // x86
-        else if (line.find(".code32") != std::string::npos || line.find(".x86") != std::string::npos ||
-            line.find("BITS 32") != std::string::npos || line.find("__i386__") != std::string::npos) {
-            architecture = "x86";
-        }
-        // ARM
-        else if (line.find(".arm") != std::string::npos || line.find(".thumb") != std::string::npos ||
-            line.find("__ARM_ARCH") != std::string::npos || line.find("__arm__") != std::string::npos) {
-            architecture = "ARM";
-        }
-        // MIPS
-        else if (line.find(".mips") != std::string::npos || line.find(".mips64") != std::string::npos ||
-            line.find("__mips__") != std::string::npos) {
-            architecture = "MIPS";
-        }
-        // PowerPC
-        else if (line.find(".ppc") != std::string::npos || line.find("__powerpc__") != std::string::npos ||
-            line.find("__ppc__") != std::string::npos) {
-            architecture = "PowerPC";
+    serve::Reader reader(fd);
+    std::string request;
+    if (!reader.line(request, REQUEST_LIMIT)) return;
+
+    std::string_view line = request;
+    try {
+        if (line.rfind(serve::FILE_REQUEST, 0) == 0) {
+            std::string_view paths = line.substr(serve::FILE_REQUEST.size());
+            size_t tab = paths.find('\t');
+            std::string input(paths.substr(0, tab));
+            std::string output = tab == std::string_view::npos ? "" : std::string(paths.substr(tab + 1));
+            if (output == "-") throw std::runtime_error("FILE requests write files; use BUFFER for the text");
+            if (!isServedPath(input, false)) throw std::runtime_error("Not an assembly file: " + input);
+            if (!output.empty() && !isServedPath(output, true)) throw std::runtime_error("Not an analysis output: " + output);
+            analyzeFile(input, nullptr, output, store, crossReference, graph, columnar);
+            static_cast<void>(serve::writeAll(fd, serve::OK_REPLY));
+        } else if (line.rfind(serve::BUFFER_REQUEST, 0) == 0) {
+            uint64_t size = 0;
+            if (!serve::parseSize(line.substr(serve::BUFFER_REQUEST.size()), size))
+                throw std::runtime_error("Invalid BUFFER size");
+            if (size > serve::BUFFER_LIMIT)
+                throw std::runtime_error("BUFFER larger than " + std::to_string(serve::BUFFER_LIMIT) + " bytes; send a FILE request");
+            if (!serve::writeAll(fd, serve::OK_REPLY)) return;
+
+            // The payload is analyzed as it arrives and the text goes out as it is produced;
+            // a failure past this point just ends it early
+            io::OutputFile out(fd);
+            std::unique_ptr<xref::Index> index;
+            if (crossReference) index = std::make_unique<xref::Index>();
+            serve::Payload in(reader, size);
+            analyzeStream(in, out, nullptr, index.get());
+            if (index != nullptr) writeAppendix(out, *index, compression::NONE);
+            out.close();
+            ++stats::totals().files;
+            stats::flush();
+        } else {
+            throw std::runtime_error("Unknown request: " + std::string(line.substr(0, line.find(' '))));
         }
-        // RISC-V
-        else if (line.find(".riscv") != std::string::npos || line.find("__riscv") != std::string::npos) {
-            architecture = "RISC-V";
-        }
-        // SPARC
-        else if (line.find(".sparc") != std::string::npos || line.find("__sparc__") != std::string::npos) {
-            architecture = "SPARC";
-        }
-
-        if (architecture != "Unknown") { break; }
+    } catch (const std::exception& e) {
+        std::string message(e.what());
+        std::replace(message.begin(), message.end(), '\n', ' ');
+        static_cast<void>(serve::writeAll(fd, std::string(serve::ERROR_REPLY) + message + '\n'));
     }
+#else
+    static_cast<void>(fd), static_cast<void>(store), static_cast<void>(crossReference);
+    static_cast<void>(graph), static_cast<void>(columnar);
+#endif
+}
 
-    file.close();
-    return architecture;
-}
\ No newline at end of file
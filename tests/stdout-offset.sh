@@ -0,0 +1,18 @@
+#!/bin/sh
+# Writing to a stdout that is already written to must not overwrite what is there.
+# usage: stdout-offset.sh ASM_ANALYZE
+set -eu
+analyzer="$1"
+dir="$(mktemp -d)"
+trap 'rm -rf "$dir"' EXIT
+
+printf 'main:\n    push rbp\n    mov rbp, rsp\n    ret\n' > "$dir/x.s"
+
+{ echo PREFIX; "$analyzer" --no-pause -o - "$dir/x.s" 2>/dev/null; } > "$dir/out"
+[ "$(head -n 1 "$dir/out")" = PREFIX ] || { echo "the output overwrote the start of stdout"; exit 1; }
+grep -q 'push' "$dir/out" || { echo "the analysis is missing"; exit 1; }
+
+echo OLD > "$dir/appended"
+"$analyzer" --no-pause -o - "$dir/x.s" >> "$dir/appended" 2>/dev/null
+[ "$(head -n 1 "$dir/appended")" = OLD ] || { echo "the output overwrote an appended file"; exit 1; }
+grep -q 'push' "$dir/appended" || { echo "the appended analysis is missing"; exit 1; }